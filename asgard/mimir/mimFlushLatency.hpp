@@ -0,0 +1,159 @@
+#ifndef MIM_FLUSH_LATENCY_HPP
+#define MIM_FLUSH_LATENCY_HPP
+
+#include "yggPosixTraits.hpp"
+#include "yggTransport.hpp"
+#include "yggTransportImpl.hpp"
+#include "yggSerializer.hpp"
+#include "yggTypeRegistry.hpp"
+#include "ratSerializableTypes.hpp"
+#include <iostream>
+
+// How late a ping and its echo go out when they are all the serializer
+// finds queued: the frames it holds for a burst must not wait for
+// MaxFlushDelayUs when nothing more is coming.
+class FlushLatencyCheck
+{
+public:
+    enum
+    {
+        ROUNDS = 5,
+        // the write that keeps the serializer busy while the pair queues
+        SLOW_WRITE_US = 5000
+    };
+    // remembers when the last write ended, the first write of a
+    // round takes SLOW_WRITE_US
+    class TimedDevice
+    {
+    public:
+        TimedDevice()
+         : mSlow(false),
+           mWrites(0),
+           mLastWrite(0)
+        {}
+        bool isOpen()
+        {
+            return true;
+        }
+        bool write(const uint8_t*, uint32_t)
+        {
+            written();
+            return true;
+        }
+        bool write(const ygg::IoChunk*, uint32_t)
+        {
+            written();
+            return true;
+        }
+        uint32_t readSome(uint8_t*, uint32_t)
+        {
+            return 0;
+        }
+        void slowDown()
+        {
+            mMutex.lock();
+            mSlow = true;
+            mMutex.unlock();
+        }
+        uint32_t writes(uint64_t& lastWrite)
+        {
+            mMutex.lock();
+            uint32_t writes = mWrites;
+            lastWrite = mLastWrite;
+            mMutex.unlock();
+            return writes;
+        }
+    private:
+        void written()
+        {
+            mMutex.lock();
+            bool slow = mSlow;
+            mSlow = false;
+            mMutex.unlock();
+            if(slow) {
+                usleep(SLOW_WRITE_US);
+            }
+            mMutex.lock();
+            ++mWrites;
+            mLastWrite = ygg::PosixUtils::getMicroseconds();
+            mMutex.unlock();
+        }
+    private:
+        ygg::PosixMutex mMutex;
+        bool            mSlow;
+        uint32_t        mWrites;
+        uint64_t        mLastWrite;
+    };
+    struct Config
+    {
+        const static ygg::ConfigCommunication Serialization  = ygg::COMMUNICATION_NONBLOCKING;
+        const static ygg::ConfigEndianness    Endianness     = ygg::ENDIAN_NATIVE;
+        const static ygg::ConfigBatching      Batching       = ygg::BATCHING_ENABLED;
+        const static ygg::ConfigIntegrity     Integrity      = ygg::INTEGRITY_SUM8;
+        const static ygg::ConfigEncoding      Encoding       = ygg::ENCODING_VARINT;
+        const static ygg::ConfigFraming       Framing        = ygg::FRAMING_SYNC;
+        const static ygg::ConfigSequencing    Sequencing     = ygg::SEQUENCING_ENABLED;
+        const static ygg::ConfigViews         Views          = ygg::VIEWS_DISABLED;
+        const static ygg::ConfigOverflow      OutputOverflow = ygg::OVERFLOW_BLOCK;
+        const static ygg::ConfigQueue         OutputQueue    = ygg::QUEUE_MPSC;
+        const static int BasePriority = 0;
+        const static int OutputQueueSize = 10;
+        const static int QueueBlockMs = 50;
+        const static int MaxFlushDelayUs = 1000;
+        const static int ReadBufferSize = 256;
+        const static int WriteBufferSize = 512;
+        const static int MaxStringLength = 256;
+        const static int DeltaKeyInterval = 32;
+    };
+    typedef ygg::ConfiguredTransport<Config, TimedDevice> Transport;
+    typedef ygg::Serializer<ygg::PosixSystemTraits, Config> Serializer;
+public:
+    // true if the pair went out well within MaxFlushDelayUs, 
+    // PingData has to be registered
+    bool run()
+    {
+        // the serializer thread never ends, it keeps what it uses
+        TimedDevice* device = new TimedDevice();
+        Transport* transport = new Transport(device);
+        transport->start();
+        Serializer* serializer = new Serializer(*transport);
+        uint64_t best = 0;
+        for(uint32_t r = 0; r < ROUNDS; ++r) {
+            uint64_t latency = round(*device, *serializer);
+            if(r == 0 || latency < best) {
+                best = latency;
+            }
+        }
+        bool ok = best < Config::MaxFlushDelayUs / 2;
+        std::cout<<"flush latency: a ping and its echo out "<<best<<" us after the "
+                 <<"serializer got them"<<(ok ? "" : ", FAILED")<<std::endl;
+        return ok;
+    }
+private:
+    // the time from the end of the slow write to the pair's write
+    uint64_t round(TimedDevice& device, Serializer& serializer)
+    {
+        uint64_t last;
+        uint32_t writes = device.writes(last);
+        device.slowDown();
+        serializer.send(new rat::PingData(1));
+        // the pair queues while the first ping is being written
+        usleep(SLOW_WRITE_US / 5);
+        serializer.send(new rat::PingData(2));
+        serializer.send(new rat::PingData(3));
+        // wait for the write of the first ping, then the pair
+        uint64_t slowEnd = 0;
+        while(device.writes(slowEnd) < writes + 1) {
+            usleep(100);
+        }
+        uint64_t pairEnd = slowEnd;
+        uint64_t deadline = ygg::PosixUtils::getMicroseconds() + 100000;
+        while(device.writes(pairEnd) < writes + 2 &&
+              ygg::PosixUtils::getMicroseconds() < deadline) {
+            usleep(20);
+        }
+        return pairEnd - slowEnd;
+    }
+};
+
+#endif //MIM_FLUSH_LATENCY_HPP
@@ -0,0 +1,169 @@
+#ifndef MIM_HELD_WRITES_HPP
+#define MIM_HELD_WRITES_HPP
+
+#include "yggTransport.hpp"
+#include "yggTransportImpl.hpp"
+#include "yggTypeRegistry.hpp"
+#include "ratSerializableTypes.hpp"
+#include <iostream>
+#include <vector>
+#include <cstring>
+
+// Frames written while the writes are held, see Transport::holdWrites,
+// read back by a transport of the same configuration.
+class HeldWritesCheck
+{
+public:
+    // an object too big for the write buffer, its first field goes
+    // out past the buffer and the last one needs it flushed again
+    class Chunks : public ygg::Record<Chunks>
+    {
+    public:
+        Chunks(uint8_t seed = 0)
+        {
+            for(uint32_t i = 0; i < sizeof(mData); ++i) {
+                mData[i] = (uint8_t)(i * 7 + seed);
+            }
+            for(uint32_t i = 0; i < sizeof(mTag); ++i) {
+                mTag[i] = (uint8_t)(i + seed);
+            }
+            for(uint32_t i = 0; i < sizeof(mTail); ++i) {
+                mTail[i] = (uint8_t)(i * 3 + seed);
+            }
+        }
+        bool operator==(const Chunks& c) const
+        {
+            return memcmp(mData, c.mData, sizeof(mData)) == 0 &&
+                   memcmp(mTag, c.mTag, sizeof(mTag)) == 0 &&
+                   memcmp(mTail, c.mTail, sizeof(mTail)) == 0;
+        }
+    private:
+        uint8_t mData[100];
+        uint8_t mTag[5];
+        uint8_t mTail[60];
+    public:
+        typedef ygg::Fields<
+            ygg::Field<Chunks, uint8_t[100], &Chunks::mData>,
+            ygg::Field<Chunks, uint8_t[5], &Chunks::mTag>,
+            ygg::Field<Chunks, uint8_t[60], &Chunks::mTail>
+        > Fields;
+    };
+    // the bytes written, read back in small pieces until they run out
+    class MemoryDevice
+    {
+    public:
+        MemoryDevice()
+         : mPos(0)
+        {}
+        bool isOpen()
+        {
+            return true;
+        }
+        bool write(const uint8_t* ptr, uint32_t size)
+        {
+            mData.insert(mData.end(), ptr, ptr + size);
+            return true;
+        }
+        bool write(const ygg::IoChunk* chunks, uint32_t count)
+        {
+            for(uint32_t i = 0; i < count; ++i) {
+                write((const uint8_t*)chunks[i].ptr, chunks[i].size);
+            }
+            return true;
+        }
+        uint32_t readSome(uint8_t* ptr, uint32_t size)
+        {
+            if(mPos == mData.size()) {
+                return 0;
+            }
+            uint32_t n = std::min<uint32_t>(std::min<uint32_t>(size, 16), mData.size() - mPos);
+            memcpy(ptr, &mData[0] + mPos, n);
+            mPos += n;
+            return n;
+        }
+        bool isDrained() const
+        {
+            return mPos == mData.size();
+        }
+    private:
+        std::vector<uint8_t> mData;
+        uint32_t             mPos;
+    };
+    template <ygg::ConfigEncoding E>
+    struct Config
+    {
+        const static ygg::ConfigEndianness Endianness      = ygg::ENDIAN_NATIVE;
+        const static ygg::ConfigIntegrity  Integrity       = ygg::INTEGRITY_SUM8;
+        const static ygg::ConfigEncoding   Encoding        = E;
+        const static ygg::ConfigFraming    Framing         = ygg::FRAMING_SYNC;
+        const static ygg::ConfigSequencing Sequencing      = ygg::SEQUENCING_ENABLED;
+        const static ygg::ConfigViews      Views           = ygg::VIEWS_DISABLED;
+        const static int ReadBufferSize = 256;
+        const static int WriteBufferSize = 64;
+        const static int MaxStringLength = 256;
+        const static int DeltaKeyInterval = 32;
+    };
+public:
+    // true if every combination of link options reads back, 
+    // PingData and Chunks have to be registered and accepted
+    bool run()
+    {
+        bool ok = true;
+        for(uint32_t options = 0; options < 16; ++options) {
+            ok = check<ygg::ENCODING_FIXED>(options) && ok;
+            ok = check<ygg::ENCODING_VARINT>(options) && ok;
+        }
+        std::cout<<"held writes: "<<(ok ? "ok" : "FAILED")<<std::endl;
+        return ok;
+    }
+private:
+    template <ygg::ConfigEncoding E>
+    bool check(uint32_t options)
+    {
+        typedef ygg::ConfiguredTransport<Config<E>, MemoryDevice> Transport;
+        MemoryDevice device;
+        Transport out(&device);
+        out.start();
+        out.acceptLinkOptions(options);
+        // a short frame stays in the buffer in front of the big one
+        out.holdWrites();
+        rat::PingData ping(1);
+        out.serialize(&ping);
+        Chunks chunks(options);
+        out.serialize(&chunks);
+        out.serialize(&ping);
+        out.releaseWrites();
+
+        Transport in(&device);
+        in.start();
+        uint32_t pings = 0;
+        uint32_t matching = 0;
+        while(true) {
+            ygg::TypeBase* d = NULL;
+            in.deserialize(d);
+            if(d == NULL) {
+                // nothing more once the bytes ran out
+                if(device.isDrained()) {
+                    break;
+                }
+                continue;
+            }
+            if(ygg::TypeRegistry::isType<rat::PingData>(d)) {
+                ++pings;
+            } else
+            if(ygg::TypeRegistry::isType<Chunks>(d)) {
+                matching += (*(Chunks*)d == chunks);
+            }
+            delete d;
+        }
+        bool ok = pings == 2 && matching == 1 && in.droppedFrames() == 0;
+        if(!ok) {
+            std::cout<<"held writes: link options "<<options<<", encoding "<<E
+                     <<": "<<pings<<" pings, "<<matching<<" matching chunks, "
+                     <<in.droppedFrames()<<" dropped frames"<<std::endl;
+        }
+        return ok;
+    }
+};
+
+#endif //MIM_HELD_WRITES_HPP
@@ -0,0 +1,107 @@
+#ifndef MIM_INTEGRITY_HPP
+#define MIM_INTEGRITY_HPP
+
+#include "yggIntegrity.hpp"
+#include "yggPosixTraits.hpp"
+#include <iostream>
+#include <vector>
+
+// Cost per byte of the frame integrity checks over a record-sized 
+// frame, the way the transport runs them: over whole buffered spans, 
+// against the sum the transport used to add up field by field.
+class IntegrityBench
+{
+public:
+    enum
+    {
+        RECORD_SIZE = 48,
+        ROUNDS = 2000000
+    };
+public:
+    IntegrityBench()
+     : mFrame(RECORD_SIZE)
+    {
+        for(uint32_t i = 0; i < RECORD_SIZE; ++i) {
+            mFrame[i] = (uint8_t)(i * 131 + 7);
+        }
+    }
+    // true if the CRCs cost no more per byte than the per-field sum
+    bool run()
+    {
+        double fields = measureFields();
+        measure<ygg::INTEGRITY_SUM8>("SUM8");
+        double crc16 = measure<ygg::INTEGRITY_CRC16>("CRC16");
+        double crc32c = measure<ygg::INTEGRITY_CRC32C>("CRC32C");
+#if defined(__SSE4_2__) && defined(__x86_64__)
+        std::cout<<"integrity: CRC32C uses the SSE4.2 crc32 instruction"<<std::endl;
+#else
+        std::cout<<"integrity: CRC32C uses tables, build with -msse4.2 for the instruction"<<std::endl;
+#endif
+        std::cout<<"integrity: CRC16 "<<crc16 / fields<<"x, CRC32C "
+                 <<crc32c / fields<<"x the per-field sum"<<std::endl;
+        return crc16 <= fields && crc32c <= fields;
+    }
+private:
+    // the fields of the record, the sizes of its primitives
+    static uint32_t fieldSize(uint32_t i)
+    {
+        static const uint8_t sizes[] = { 8, 8, 8, 4, 4, 4, 4, 2, 2, 2, 1, 1 };
+        return sizes[i % sizeof(sizes)];
+    }
+    // the sum of one primitive, the way each write added it
+    static uint8_t sumField(const uint8_t* p, uint32_t size)
+    {
+        switch(size) {
+        case 1:
+            return p[0];
+        case 2:
+            return p[0] + p[1];
+        case 4:
+            return p[0] + p[1] + p[2] + p[3];
+        default:
+            return p[0] + p[1] + p[2] + p[3] + p[4] + p[5] + p[6] + p[7];
+        }
+    }
+    double measureFields()
+    {
+        volatile uint8_t v = 0;
+        uint64_t begin = ygg::PosixUtils::getMicroseconds();
+        for(uint32_t r = 0; r < ROUNDS; ++r) {
+            // a new frame each round, the work can't be hoisted
+            mFrame[0] = (uint8_t)r;
+            uint8_t sum = 0;
+            for(uint32_t pos = 0, i = 0; pos < RECORD_SIZE; pos += fieldSize(i++)) {
+                sum += sumField(&mFrame[pos], fieldSize(i));
+            }
+            v = sum;
+        }
+        uint64_t end = ygg::PosixUtils::getMicroseconds();
+        (void)v;
+        return report("per-field sum", begin, end);
+    }
+    template <ygg::ConfigIntegrity I>
+    double measure(const char* name)
+    {
+        typedef ygg::Integrity<I> Check;
+        // the tables are built on the first use
+        volatile uint32_t v = Check::update(Check::initial(), &mFrame[0], 1);
+        uint64_t begin = ygg::PosixUtils::getMicroseconds();
+        for(uint32_t r = 0; r < ROUNDS; ++r) {
+            mFrame[0] = (uint8_t)r;
+            v = Check::value(Check::update(Check::initial(), &mFrame[0], RECORD_SIZE));
+        }
+        uint64_t end = ygg::PosixUtils::getMicroseconds();
+        (void)v;
+        return report(name, begin, end);
+    }
+    double report(const char* name, uint64_t begin, uint64_t end)
+    {
+        double ns = (end - begin) * 1000.0 / ((double)ROUNDS * RECORD_SIZE);
+        std::cout<<"integrity: "<<name<<" "<<ns<<" ns/byte"<<std::endl;
+        return ns;
+    }
+private:
+    std::vector<uint8_t> mFrame;
+};
+
+#endif //MIM_INTEGRITY_HPP
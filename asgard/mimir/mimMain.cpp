@@ -0,0 +1,30 @@
+#include <string>
+#include "mimIntegrity.hpp"
+#include "mimHeldWrites.hpp"
+#include "mimFlushLatency.hpp"
+#include <iostream>
+
+// Measurements and checks of the serialization system, run on the 
+// host, a failed check makes the exit status 1.
+int main()
+{
+    IntegrityBench integrity;
+    if(!integrity.run()) {
+        std::cout<<"integrity: the CRCs cost more per byte than the per-field sum"<<std::endl;
+    }
+    // the types of the checks, read back by the same program
+    typedef ygg::TypeRegistry registry;
+    registry::addType<rat::PingData>("PingData", 1);
+    registry::addType<HeldWritesCheck::Chunks>("Chunks", 1);
+    registry::initialize();
+    registry::acceptType(ygg::TypeDescriptor<rat::PingData>::id(),
+                         ygg::TypeDescriptor<rat::PingData>::id());
+    registry::acceptType(ygg::TypeDescriptor<HeldWritesCheck::Chunks>::id(),
+                         ygg::TypeDescriptor<HeldWritesCheck::Chunks>::id());
+    bool ok = true;
+    HeldWritesCheck heldWrites;
+    ok = heldWrites.run() && ok;
+    FlushLatencyCheck flushLatency;
+    ok = flushLatency.run() && ok;
+    return ok ? 0 : 1;
+}
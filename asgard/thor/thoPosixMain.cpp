@@ -1,9 +1,11 @@
 #include "yggSerializationManager.hpp"
 #include "yggReplayManager.hpp"
+#include "yggView.hpp"
 #include "yggPosixTraits.hpp"
 #include "ratSerializableTypes.hpp"
 #include <iostream>
 #include <string>
+#include <csignal>
 
 using namespace std;
 struct ThorPosixConfig
@@ -13,11 +15,30 @@ struct ThorPosixConfig
     const static ygg::ConfigCommunication   Deserialization  = ygg::COMMUNICATION_NONBLOCKING;
     const static ygg::ConfigEndianness      Endianness       = ygg::ENDIAN_NATIVE;
     const static ygg::ConfigManifest        ManifestRequired = ygg::MANIFEST_REQUIRED;
+    const static ygg::ConfigBatching        Batching         = ygg::BATCHING_ENABLED;
+    const static ygg::ConfigIntegrity       Integrity        = ygg::INTEGRITY_SUM8;
+    const static ygg::ConfigEncoding        Encoding         = ygg::ENCODING_VARINT;
+    const static ygg::ConfigFraming         Framing          = ygg::FRAMING_SYNC;
+    const static ygg::ConfigLogFormat       LogFormat        = ygg::LOG_COMPRESSED;
+    const static ygg::ConfigSequencing      Sequencing       = ygg::SEQUENCING_ENABLED;
+    const static ygg::ConfigViews           Views            = ygg::VIEWS_ENABLED;
+    const static ygg::ConfigAllocation      Allocation       = ygg::ALLOCATION_POOLED;
+    const static ygg::ConfigOverflow        InputOverflow    = ygg::OVERFLOW_DROP_NEWEST;
+    const static ygg::ConfigQueue           InputQueue       = ygg::QUEUE_RING;
+    const static ygg::ConfigOverflow        OutputOverflow   = ygg::OVERFLOW_BLOCK;
+    const static ygg::ConfigQueue           OutputQueue      = ygg::QUEUE_MPSC;
     // various parameters of the serialization system
     const static int BasePriority = 0;
     const static int InputQueueSize = 10;
     const static int OutputQueueSize = 10;
+    const static int QueueBlockMs = 50;
+    const static int MaxFlushDelayUs = 1000;
     const static int ManifestRequestMs = 1000;
+    const static int ReadBufferSize = 1024;
+    const static int WriteBufferSize = 512;
+    const static int MaxStringLength = 4096;
+    const static int DeltaKeyInterval = 32;
+    const static int ObjectPoolSize = 24;
 };
 
 class PCTerminator
@@ -43,6 +64,24 @@ typedef ygg::ReplayManager<
 class PCInputHandler
 {
 public:
+    // pings and accelerometer readings are only printed, 
+    // they are read where they were received
+    bool processView(const ygg::ObjectView& v)
+    {
+        if(registry::isType<rat::PingData>(v)) {
+            ygg::View<rat::PingData> pv(v);
+            uint32_t rtt = (uint32_t)v.arrivalTime() - pv.get<0>();
+            std::cout<<"roundtrip: "<<rtt<<"us"<<std::endl;
+            return true;
+        }
+        if(registry::isType<rat::LISData>(v)) {
+            ygg::View<rat::LISData> lv(v);
+            rat::Axes a = lv.get<0>();
+            std::cout<<"lis: ["<<(uint32_t)a.x<<", "<<(uint32_t)a.y<<", "<<(uint32_t)a.z<<"]"<<std::endl;
+            return true;
+        }
+        return false;
+    }
     void process(ygg::TypeBase* d)
     {
         if(registry::isType<rat::StrCmdData>(d)) {
@@ -51,7 +90,9 @@ public:
         } else
         if(registry::isType<rat::PingData>(d)) {
             rat::PingData* pd = (rat::PingData*)d;
-            std::cout<<"roundtrip: "<< sm::Utils::getMilliseconds() - pd->timeStamp()<<"ms"<<std::endl;
+            // the ping carries the low bits of the sending time
+            uint32_t rtt = (uint32_t)pd->arrivalTime() - pd->timeStamp();
+            std::cout<<"roundtrip: "<<rtt<<"us"<<std::endl;
         } else 
         if(registry::isType<rat::LISData>(d)) {
             rat::LISData* ld = (rat::LISData*)d;
@@ -65,14 +106,32 @@ public:
 
 static bool pingerFunc(void* param)
 {
-    sm::send(new rat::PingData(sm::Utils::getMilliseconds()));
+    sm::send(new rat::PingData((uint32_t)sm::Utils::getMicroseconds()));
     sm::Thread::sleepMilliseconds(200);
     std::cout<<"sending ping..."<<std::endl;
+    sm::LinkStatistics stats = sm::statistics();
+    std::cout<<"link: lost "<<stats.lostFrames<<", dropped "<<stats.droppedFrames
+             <<", queue drops "<<stats.inputQueueDrops + stats.outputQueueDrops
+             <<", queue peaks "<<stats.inputQueueHighWater<<"/"<<stats.outputQueueHighWater<<std::endl;
+    ygg::ObjectPoolBase::Statistics pool = 
+        registry::poolStatistics(ygg::TypeDescriptor<rat::PingData>::id());
+    std::cout<<"ping pool: hits "<<pool.hits<<", misses "<<pool.misses<<std::endl;
     return false;
 }
 
+// set by SIGINT/SIGTERM, ends the main loop
+static volatile sig_atomic_t quit = 0;
+
+static void onSignal(int)
+{
+    quit = 1;
+}
+
 int main()
 {
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
     // register a dummy type
     registry::addType<rat::BasicType<float, 2> >("BasicType4", 1);
     // register ping type
@@ -99,14 +158,16 @@ int main()
     if(!ldevice.isOpen()) {
         return 1;
     }
-    sm::Logger logger(&ldevice);
+    // blocks of the compressed log are closed at least once a second
+    sm::LogDevice logdevice(&ldevice, &sm::Utils::getMicroseconds);
+    sm::Logger logger(&logdevice);
     // start the service
     sm::startService(transport, handler);
     sm::startLogger(logger);
     // add a thread that sends ping once in a while (set to ~5hz)
     sm::Thread pinger("Pinger", 0, 0, pingerFunc, NULL, NULL);
     // Note that the current configuration is non-blocking and we 
-    // need the while(true) trap below...
+    // need the trap below, until a signal comes...
 
 #else
     rm::DeviceParams lparams= { "logfile.out" };
@@ -115,16 +176,23 @@ int main()
         return 1;
     }
 
-    rm::Transport log(&ldevice);
+    rm::LogDevice logdevice(&ldevice);
+    rm::Transport log(&logdevice);
 
     PCTerminator terminator;
     rm::startReplay(log, handler, terminator);
 #endif
 
 
-    while(true) {
+    while(!quit) {
         sleep(1);
     }
-    return 0;
-
+#if SERVICE
+    // write out the last block of the log
+    sm::stopLogger();
+    logdevice.flush();
+#endif
+    // the service threads are never joined, leave without destroying
+    // what they still use
+    _exit(0);
 }
@@ -41,7 +41,8 @@ int main( int argc, char ** argv )
         return 1;
     }
 
-    sm::Logger logger(&ldevice);
+    sm::LogDevice logdevice(&ldevice);
+    sm::Logger logger(&logdevice);
 
     // start the service
     sm::startService(transport, handler);
@@ -15,11 +15,30 @@ struct ThorQtConfig
     const static ygg::ConfigCommunication   Deserialization  = ygg::COMMUNICATION_NONBLOCKING;
     const static ygg::ConfigEndianness      Endianness       = ygg::ENDIAN_NATIVE;
     const static ygg::ConfigManifest        ManifestRequired = ygg::MANIFEST_REQUIRED;
+    const static ygg::ConfigBatching        Batching         = ygg::BATCHING_ENABLED;
+    const static ygg::ConfigIntegrity       Integrity        = ygg::INTEGRITY_SUM8;
+    const static ygg::ConfigEncoding        Encoding         = ygg::ENCODING_VARINT;
+    const static ygg::ConfigFraming         Framing          = ygg::FRAMING_SYNC;
+    const static ygg::ConfigLogFormat       LogFormat        = ygg::LOG_COMPRESSED;
+    const static ygg::ConfigSequencing      Sequencing       = ygg::SEQUENCING_ENABLED;
+    const static ygg::ConfigViews           Views            = ygg::VIEWS_DISABLED;
+    const static ygg::ConfigAllocation      Allocation       = ygg::ALLOCATION_HEAP;
+    const static ygg::ConfigOverflow        InputOverflow    = ygg::OVERFLOW_DROP_OLDEST;
+    const static ygg::ConfigQueue           InputQueue       = ygg::QUEUE_LIST;
+    const static ygg::ConfigOverflow        OutputOverflow   = ygg::OVERFLOW_BLOCK;
+    const static ygg::ConfigQueue           OutputQueue      = ygg::QUEUE_MPSC;
     // various parameters of the serialization system
     const static int BasePriority = 0;
     const static int InputQueueSize = 10;
     const static int OutputQueueSize = 10;
+    const static int QueueBlockMs = 50;
+    const static int MaxFlushDelayUs = 1000;
     const static int ManifestRequestMs = 1000;
+    const static int ReadBufferSize = 1024;
+    const static int WriteBufferSize = 512;
+    const static int MaxStringLength = 4096;
+    const static int DeltaKeyInterval = 32;
+    const static int ObjectPoolSize = 0;
 };
 
 typedef ygg::SerializationManager<
@@ -18,11 +18,30 @@ struct ChibiosConfig
     const static ygg::ConfigCommunication   Deserialization  = ygg::COMMUNICATION_NONBLOCKING;
     const static ygg::ConfigEndianness      Endianness       = ygg::ENDIAN_NATIVE;
     const static ygg::ConfigManifest        ManifestRequired = ygg::MANIFEST_REQUIRED;
+    const static ygg::ConfigBatching        Batching         = ygg::BATCHING_ENABLED;
+    const static ygg::ConfigIntegrity       Integrity        = ygg::INTEGRITY_SUM8;
+    const static ygg::ConfigEncoding        Encoding         = ygg::ENCODING_VARINT;
+    const static ygg::ConfigFraming         Framing          = ygg::FRAMING_SYNC;
+    const static ygg::ConfigLogFormat       LogFormat        = ygg::LOG_RAW;
+    const static ygg::ConfigSequencing      Sequencing       = ygg::SEQUENCING_ENABLED;
+    const static ygg::ConfigViews           Views            = ygg::VIEWS_DISABLED;
+    const static ygg::ConfigAllocation      Allocation       = ygg::ALLOCATION_POOLED;
+    const static ygg::ConfigOverflow        InputOverflow    = ygg::OVERFLOW_DROP_NEWEST;
+    const static ygg::ConfigQueue           InputQueue       = ygg::QUEUE_RING;
+    const static ygg::ConfigOverflow        OutputOverflow   = ygg::OVERFLOW_LATEST;
+    const static ygg::ConfigQueue           OutputQueue      = ygg::QUEUE_LIST;
     // various parameters of the serialization system
     const static int BasePriority = NORMALPRIO+10;
     const static int InputQueueSize = 10;
     const static int OutputQueueSize = 10;
+    const static int QueueBlockMs = 0;
+    const static int MaxFlushDelayUs = 500;
     const static int ManifestRequestMs = 1000;
+    const static int ReadBufferSize = 128;
+    const static int WriteBufferSize = 128;
+    const static int MaxStringLength = 128;
+    const static int DeltaKeyInterval = 32;
+    const static int ObjectPoolSize = 8;
 };
 class ChInputHandler;
 
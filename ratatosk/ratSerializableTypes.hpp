@@ -2,6 +2,7 @@
 #define RAT_SERIALIZATION_TYPES_HPP
 
 #include "ratTypes.hpp"
+#include "yggFields.hpp"
 #include <list>
 #include <cassert>
 
@@ -12,27 +13,18 @@ template <typename T> class Serializable;
 
 // a simple type that can be used for serialization of basic objects and object-arrays
 template <typename Type, uint32_t size>
-class BasicType : public ygg::Serializable<BasicType<Type, size> >
+class BasicType : public ygg::Record<BasicType<Type, size> >
 {
-public:
-    void write(ygg::Transport& transport) const
-    {
-        for(uint32_t i = 0; i < size; ++i) {
-            transport.write(m_array[i]);
-        }
-    }
-    void read(ygg::Transport& transport)  
-    {
-        for(uint32_t i = 0; i < size; ++i) {
-            transport.read(m_array[i]);
-        }
-    }
 private:
     Type  m_array[size];
+public:
+    typedef ygg::Fields<
+        ygg::Field<BasicType, Type[size], &BasicType::m_array>
+    > Fields;
 };
 
 // a simple type that can be used for serialization of string commands...
-class StrCmdData: public ygg::Serializable<StrCmdData>
+class StrCmdData: public ygg::Record<StrCmdData>
 {
 public:
     StrCmdData() 
@@ -40,23 +32,19 @@ public:
     StrCmdData(const std::string& str)
      : mString(str)
     {}
-    void write(ygg::Transport& transport) const
-    {
-        transport.write(mString);
-    }
-    void read(ygg::Transport& transport)  
-    {
-        transport.read(mString);
-    }
     const std::string& string() const
     {
         return mString;
     }
 private:
     std::string mString;
+public:
+    typedef ygg::Fields<
+        ygg::Field<StrCmdData, std::string, &StrCmdData::mString>
+    > Fields;
 };
 
-class LISData : public ygg::Serializable<LISData>
+class LISData : public ygg::Record<LISData>
 {
     typedef rat::Axes Axes;
 public:
@@ -64,49 +52,71 @@ public:
       : mAxes(axes)
     {
     }
-    void write(ygg::Transport& transport) const
-    {
-        transport.write(mAxes.x);
-        transport.write(mAxes.y);
-        transport.write(mAxes.z);
-    }
-    void read(ygg::Transport& transport)  
-    {
-        transport.read(mAxes.x);
-        transport.read(mAxes.y);
-        transport.read(mAxes.z);
-    }
     const Axes& axes() const
     {
         return mAxes;
     }
 private:
     Axes mAxes;
+public:
+    typedef ygg::Fields<
+        ygg::Field<LISData, Axes, &LISData::mAxes>
+    > Fields;
 };
 
-class PingData: public ygg::Serializable<PingData>
+class PingData: public ygg::Record<PingData>
 {
 public:
     PingData(const uint32_t& timeStamp = 0)
      : mTimeStamp(timeStamp)
     {
     }
-    void write(ygg::Transport& transport) const
-    {
-        transport.write(mTimeStamp);
-    }
-    void read(ygg::Transport& transport)  
-    {
-        transport.read(mTimeStamp);
-    }
     const uint32_t & timeStamp() const
     {
         return mTimeStamp;
     }
 private:
     uint32_t mTimeStamp;
+public:
+    typedef ygg::Fields<
+        ygg::Field<PingData, uint32_t, &PingData::mTimeStamp>
+    > Fields;
 };
 
 } // namespace rat
 
+namespace ygg
+{
+
+template <>
+struct FieldsOf<rat::Axes>
+{
+    typedef ygg::Fields<
+        ygg::Field<rat::Axes, uint8_t, &rat::Axes::x>,
+        ygg::Field<rat::Axes, uint8_t, &rat::Axes::y>,
+        ygg::Field<rat::Axes, uint8_t, &rat::Axes::z>
+    > Type;
+};
+
+// Axes and the arrays of BasicType go to the buffer in one copy
+template <>
+struct PlainLayout<rat::Axes>
+{
+    enum
+    {
+        VALUE = true
+    };
+};
+
+template <typename Type, uint32_t size>
+struct PlainLayout<rat::BasicType<Type, size> >
+{
+    enum
+    {
+        VALUE = true
+    };
+};
+
+} // namespace ygg
+
 #endif //RAT_SERIALIZATION_TYPES_HPP
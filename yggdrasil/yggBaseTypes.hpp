@@ -2,7 +2,30 @@
 #define YGG_BASE_TYPES_HPP
 
 #include <stdint.h>
+#include <cstddef>
 
 // TBD: need to add basic type definitions here...
 
+namespace ygg
+{
+
+// a piece of a gathered write, the devices take a list of them 
+// and send it in as few calls as they can
+struct IoChunk
+{
+    const void* ptr;
+    uint32_t    size;
+};
+
+// link of the objects in the intrusive queues, see MpscQueue
+struct QueueLink
+{
+    QueueLink()
+     : mNext(NULL)
+    {}
+    QueueLink* volatile mNext;
+};
+
+} // namespace ygg
+
 #endif //YGG_BASE_TYPES_HPP
@@ -0,0 +1,65 @@
+#ifndef YGG_BYTE_SCAN_HPP
+#define YGG_BYTE_SCAN_HPP
+
+#include <stdint.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace ygg
+{
+
+// Finds the first of the bytes A, B and C in a block. 16 bytes are
+// compared at a time (pcmpeqb/vceq) when available.
+template <uint8_t A, uint8_t B, uint8_t C>
+class ByteScan
+{
+public:
+    // returns the offset of the first match or size if there is none
+    static uint32_t find(const void* ptr, uint32_t size)
+    {
+        const uint8_t* bptr = (const uint8_t*)ptr;
+        uint32_t i = 0;
+#if defined(__SSE2__)
+        const __m128i a = _mm_set1_epi8((char)A);
+        const __m128i b = _mm_set1_epi8((char)B);
+        const __m128i c = _mm_set1_epi8((char)C);
+        for(; i + 16 <= size; i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(bptr + i));
+            __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, a),
+                                                  _mm_cmpeq_epi8(v, b)),
+                                     _mm_cmpeq_epi8(v, c));
+            int mask = _mm_movemask_epi8(m);
+            if(mask) {
+                return i + __builtin_ctz(mask);
+            }
+        }
+#elif defined(__ARM_NEON)
+        const uint8x16_t a = vdupq_n_u8(A);
+        const uint8x16_t b = vdupq_n_u8(B);
+        const uint8x16_t c = vdupq_n_u8(C);
+        for(; i + 16 <= size; i += 16) {
+            uint8x16_t v = vld1q_u8(bptr + i);
+            uint8x16_t m = vorrq_u8(vorrq_u8(vceqq_u8(v, a), vceqq_u8(v, b)),
+                                    vceqq_u8(v, c));
+            uint64x2_t m64 = vreinterpretq_u64_u8(m);
+            if(vgetq_lane_u64(m64, 0) | vgetq_lane_u64(m64, 1)) {
+                // the match is in this block, the loop below finds it
+                break;
+            }
+        }
+#endif
+        for(; i < size; ++i) {
+            if(bptr[i] == A || bptr[i] == B || bptr[i] == C) {
+                return i;
+            }
+        }
+        return size;
+    }
+};
+
+} // namespace ygg
+
+#endif //YGG_BYTE_SCAN_HPP
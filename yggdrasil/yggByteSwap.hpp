@@ -0,0 +1,54 @@
+#ifndef YGG_BYTE_SWAP_HPP
+#define YGG_BYTE_SWAP_HPP
+
+#include <stdint.h>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace ygg
+{
+
+// Reverses the byte order of arrays of L byte elements. 16 bytes are
+// done at a time with a byte shuffle (pshufb/vrev) when available.
+template <int L>
+class ByteSwap
+{
+public:
+    // swaps n elements from src to dst, the two must not overlap
+    static void copy(void* dst, const void* src, uint32_t n)
+    {
+        uint8_t* d = (uint8_t*)dst;
+        const uint8_t* s = (const uint8_t*)src;
+        const uint32_t step = 16 / L;
+#if defined(__SSSE3__)
+        uint8_t order[16];
+        for(uint32_t i = 0; i < 16; ++i) {
+            order[i] = (i / L) * L + L - 1 - i % L;
+        }
+        const __m128i mask = _mm_loadu_si128((const __m128i*)order);
+        for(; n >= step; n -= step, s += 16, d += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*)s);
+            _mm_storeu_si128((__m128i*)d, _mm_shuffle_epi8(v, mask));
+        }
+#elif defined(__ARM_NEON)
+        for(; n >= step; n -= step, s += 16, d += 16) {
+            uint8x16_t v = vld1q_u8(s);
+            v = (L == 2) ? vrev16q_u8(v) : (L == 4) ? vrev32q_u8(v) : vrev64q_u8(v);
+            vst1q_u8(d, v);
+        }
+#endif
+        for(; n; --n, s += L, d += L) {
+            for(uint32_t i = 0; i < (uint32_t)L; ++i) {
+                d[i] = s[L - 1 - i];
+            }
+        }
+        (void)step;
+    }
+};
+
+} // namespace ygg
+
+#endif //YGG_BYTE_SWAP_HPP
@@ -2,6 +2,9 @@
 #define YGG_CHIBIOS_TRAITS_HPP
 
 #include "ch.hpp"
+#include "hal.h"
+#include "yggBaseTypes.hpp"
+#include "yggPool.hpp"
 #include <fcntl.h>
 #include <unistd.h>
 #include <stdio.h>
@@ -29,17 +32,56 @@ class ChibiosCondVar : public chibios_rt::CondVar
 {
 public:
     ChibiosCondVar(chibios_rt::Mutex& mutex) 
+     : mCondMutex(mutex)
     {
-        (void)mutex;
     }
     void wait() 
     {
         Wait();
     }
+    // false once ms passed without a signal
+    bool wait(uint32_t ms)
+    {
+        return waitTicks(MS2ST(ms));
+    }
+    // the end of a wait that may be woken up several times
+    struct Deadline
+    {
+        systime_t start;
+        systime_t ticks;
+    };
+    static Deadline deadline(uint32_t ms)
+    {
+        Deadline d;
+        d.start = chTimeNow();
+        d.ticks = MS2ST(ms);
+        return d;
+    }
+    // false once the deadline passed without a signal
+    bool waitUntil(const Deadline& d)
+    {
+        systime_t elapsed = chTimeNow() - d.start;
+        if(elapsed >= d.ticks) {
+            return false;
+        }
+        return waitTicks(d.ticks - elapsed);
+    }
     void signal() 
     {
         Signal();
     }
+private:
+    bool waitTicks(systime_t ticks)
+    {
+        if(WaitTimeout(ticks) == RDY_TIMEOUT) {
+            // ChibiOS gives the mutex back only when signalled
+            mCondMutex.Lock();
+            return false;
+        }
+        return true;
+    }
+private:
+    chibios_rt::Mutex& mCondMutex;
 };
 
 class ChibiosThread 
@@ -130,10 +172,30 @@ public:
     {
         return sdRead(mSD, (uint8_t*)ptr, size) == size;
     }
+    uint32_t readSome(void* ptr, uint32_t size)
+    {
+        // wait for the first byte, then take whatever is already queued
+        msg_t b = sdGet(mSD);
+        if(b < Q_OK) {
+            return 0;
+        }
+        uint8_t* bptr = (uint8_t*)ptr;
+        bptr[0] = (uint8_t)b;
+        return 1 + sdReadTimeout(mSD, bptr + 1, size - 1, TIME_IMMEDIATE);
+    }
     bool write(const void* ptr, uint32_t size) 
     {
         return sdWrite(mSD, (uint8_t*)ptr, size) == size;
     }
+    bool write(const IoChunk* chunks, uint32_t count)
+    {
+        for(uint32_t i = 0; i < count; ++i) {
+            if(!write(chunks[i].ptr, chunks[i].size)) {
+                return false;
+            }
+        }
+        return true;
+    }
     bool isOpen() 
     {
         return mSD->state == SD_READY;
@@ -150,8 +212,126 @@ public:
     {
         return ((chTimeNow()-1L)*1000L)/CH_FREQUENCY + 1L;
     }
+    // arms the timer that carries the counter past its wraps, 
+    // before any thread reads the clock
+    static void start()
+    {
+        chSysLock();
+        if(!chVTIsArmedI(&clock().timer)) {
+            extendI();
+            chVTSetI(&clock().timer, period(), &tick, NULL);
+        }
+        chSysUnlock();
+    }
+    // monotonic, the realtime counter of the HAL (HAL_IMPLEMENTS_COUNTERS)
+    // extended past its wrap, valid after start()
+    static uint64_t getMicroseconds()
+    {
+        chSysLock();
+        uint64_t counts = extendI();
+        chSysUnlock();
+        uint64_t frequency = halGetCounterFrequency();
+        return (counts / frequency) * 1000000 + (counts % frequency) * 1000000 / frequency;
+    }
+private:
+    struct Clock
+    {
+        VirtualTimer timer;
+        halrtcnt_t   last;
+        uint64_t     wraps;
+    };
+    static Clock& clock()
+    {
+        static Clock sClock;
+        return sClock;
+    }
+    // the counter read at least twice per wrap
+    static systime_t period()
+    {
+        uint64_t half = (uint64_t)1 << (sizeof(halrtcnt_t) * 8 - 1);
+        uint64_t ticks = half * CH_FREQUENCY / halGetCounterFrequency();
+        uint64_t most = (uint64_t)1 << (sizeof(systime_t) * 8 - 1);
+        return (systime_t)(ticks < 1 ? 1 : (ticks > most ? most : ticks));
+    }
+    static uint64_t extendI()
+    {
+        halrtcnt_t now = halGetCounterValue();
+        if(now < clock().last) {
+            clock().wraps += (uint64_t)1 << (sizeof(halrtcnt_t) * 8);
+        }
+        clock().last = now;
+        return clock().wraps + now;
+    }
+    // from the system tick, unlocked
+    static void tick(void*)
+    {
+        chSysLockFromIsr();
+        extendI();
+        chVTSetI(&clock().timer, period(), &tick, NULL);
+        chSysUnlockFromIsr();
+    }
 };
 
+// ChibiOS memory pool over a block taken from the core allocator,
+// it is never given back so the heap doesn't fragment
+class ChibiosPool : public ObjectPoolBase
+{
+public:
+    ChibiosPool(uint32_t objectSize, uint32_t capacity)
+     : mObjectSize(objectSize),
+       mSlotSize(slotSize(objectSize)),
+       mBegin((uint8_t*)chCoreAlloc(mSlotSize * capacity)),
+       mEnd(mBegin ? mBegin + mSlotSize * capacity : NULL)
+    {
+        chPoolInit(&mPool, mSlotSize, NULL);
+        if(mBegin) {
+            chPoolLoadArray(&mPool, mBegin, capacity);
+            mStats.capacity = capacity;
+            mStats.available = capacity;
+        }
+    }
+    void* allocate(size_t size)
+    {
+        void* ptr = NULL;
+        chSysLock();
+        if(size <= mObjectSize) {
+            ptr = chPoolAllocI(&mPool);
+        }
+        if(ptr) {
+            --mStats.available;
+            ++mStats.hits;
+        } else {
+            ++mStats.misses;
+        }
+        chSysUnlock();
+        return ptr;
+    }
+    bool release(void* ptr)
+    {
+        if((uint8_t*)ptr < mBegin || (uint8_t*)ptr >= mEnd) {
+            return false;
+        }
+        chSysLock();
+        chPoolFreeI(&mPool, ptr);
+        ++mStats.available;
+        chSysUnlock();
+        return true;
+    }
+    Statistics statistics()
+    {
+        chSysLock();
+        Statistics stats = mStats;
+        chSysUnlock();
+        return stats;
+    }
+private:
+    uint32_t      mObjectSize;
+    uint32_t      mSlotSize;
+    uint8_t*      mBegin;
+    uint8_t*      mEnd;
+    MemoryPool    mPool;
+    Statistics    mStats;
+};
 
 class ChibiosSystemTraits
 {
@@ -161,6 +341,7 @@ public:
     typedef ChibiosThread      ThreadType;
     typedef ChibiosDevice      DeviceType;
     typedef ChibiosUtils       Utils;
+    typedef ChibiosPool        PoolType;
 };
 
 } //namespace ygg 
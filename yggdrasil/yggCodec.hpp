@@ -0,0 +1,446 @@
+#ifndef YGG_CODEC_HPP
+#define YGG_CODEC_HPP
+
+#include "yggTransport.hpp"
+#include "yggTransportImpl.hpp"
+#include "yggTypes.hpp"
+#include "yggConfig.hpp"
+#include <cstring>
+
+namespace ygg
+{
+
+// Encoder and Decoder work on the buffers of a transport with the
+// endianness known at compile time, types written against them get
+// all the primitive accesses inlined. Same API as the Transport.
+template <ConfigEndianness E>
+class Encoder
+{
+public:
+    Encoder(Transport& transport)
+     : mTransport(transport)
+    {}
+    void write(uint64_t intd)
+    {
+        writeFixed(intd);
+    }
+    void write(int64_t intd)
+    {
+        writeFixed(intd);
+    }
+    void write(uint32_t intd)
+    {
+        writeFixed(intd);
+    }
+    void write(int32_t intd)
+    {
+        writeFixed(intd);
+    }
+    void write(uint16_t intd)
+    {
+        writeFixed(intd);
+    }
+    void write(int16_t intd)
+    {
+        writeFixed(intd);
+    }
+    void write(uint8_t intd)
+    {
+        writeFixed(intd);
+    }
+    void write(int8_t intd)
+    {
+        writeFixed(intd);
+    }
+    void write(float floatd)
+    {
+        writeFixed(floatd);
+    }
+    void write(double doubled)
+    {
+        writeFixed(doubled);
+    }
+    void write(const std::string& stringd)
+    {
+        mTransport.write(stringd);
+    }
+    template <class T> void writeArray(const T* ptr, uint32_t n)
+    {
+        mTransport.writeArray(ptr, n);
+    }
+    template <class T> void writeChecksumed(const T& td)
+    {
+        mTransport.writeChecksumed(td);
+    }
+    bool isFunctional() const
+    {
+        return mTransport.isFunctional();
+    }
+    // size bytes at the end of the write buffer, the caller has to fill
+    // them all, NULL if the buffer has no room
+    uint8_t* reserve(uint32_t size)
+    {
+        Transport& t = mTransport;
+        if(t.mWriteSize + size > t.mWriteBufferSize) {
+            return NULL;
+        }
+        uint8_t* ptr = t.mWriteBuffer + t.mWriteSize;
+        t.mWriteSize += size;
+        return ptr;
+    }
+    // stores v at ptr and moves past it, for the bytes got by reserve
+    template <class T> static void store(uint8_t*& ptr, T v)
+    {
+        Transport::fixEndianness<E,sizeof(T)>(&v);
+        memcpy(ptr, &v, sizeof(T));
+        ptr += sizeof(T);
+    }
+private:
+    template <class T> void writeFixed(T v)
+    {
+        Transport::fixEndianness<E,sizeof(T)>(&v);
+        Transport& t = mTransport;
+        if(t.mWriteSize + sizeof(T) <= t.mWriteBufferSize) {
+            memcpy(t.mWriteBuffer + t.mWriteSize, &v, sizeof(T));
+            t.mWriteSize += sizeof(T);
+        } else {
+            t.write(&v, sizeof(T));
+        }
+    }
+private:
+    Transport& mTransport;
+};
+
+template <ConfigEndianness E>
+class Decoder
+{
+public:
+    Decoder(Transport& transport)
+     : mTransport(transport)
+    {}
+    void read(uint64_t& intd)
+    {
+        readFixed(intd);
+    }
+    void read(int64_t& intd)
+    {
+        readFixed(intd);
+    }
+    void read(uint32_t& intd)
+    {
+        readFixed(intd);
+    }
+    void read(int32_t& intd)
+    {
+        readFixed(intd);
+    }
+    void read(uint16_t& intd)
+    {
+        readFixed(intd);
+    }
+    void read(int16_t& intd)
+    {
+        readFixed(intd);
+    }
+    void read(uint8_t& intd)
+    {
+        readFixed(intd);
+    }
+    void read(int8_t& intd)
+    {
+        readFixed(intd);
+    }
+    void read(float& floatd)
+    {
+        readFixed(floatd);
+    }
+    void read(double& doubled)
+    {
+        readFixed(doubled);
+    }
+    void read(std::string& stringd)
+    {
+        mTransport.read(stringd);
+    }
+    bool readView(const char*& str, uint32_t& len)
+    {
+        return mTransport.readView(str, len);
+    }
+    template <class T> void readArray(T* ptr, uint32_t n)
+    {
+        mTransport.readArray(ptr, n);
+    }
+    template <class T> void readChecksumed(T& td)
+    {
+        mTransport.readChecksumed(td);
+    }
+    bool isFunctional() const
+    {
+        return mTransport.isFunctional();
+    }
+    // the next size bytes if they are all buffered, NULL otherwise
+    const uint8_t* consume(uint32_t size)
+    {
+        Transport& t = mTransport;
+        if(t.mReadEnd - t.mReadPos < size) {
+            return NULL;
+        }
+        const uint8_t* ptr = t.mReadBuffer + t.mReadPos;
+        t.mReadPos += size;
+        return ptr;
+    }
+    template <class T> static void load(const uint8_t*& ptr, T& v)
+    {
+        memcpy(&v, ptr, sizeof(T));
+        Transport::fixEndianness<E,sizeof(T)>(&v);
+        ptr += sizeof(T);
+    }
+private:
+    template <class T> void readFixed(T& v)
+    {
+        Transport& t = mTransport;
+        if(t.mReadEnd - t.mReadPos >= sizeof(T)) {
+            memcpy(&v, t.mReadBuffer + t.mReadPos, sizeof(T));
+            t.mReadPos += sizeof(T);
+        } else {
+            t.read(&v, sizeof(T));
+        }
+        Transport::fixEndianness<E,sizeof(T)>(&v);
+    }
+private:
+    Transport& mTransport;
+};
+
+// Delta coding of the fields, integers go as zigzag varints of the 
+// difference to the same field of the previous object of the type. 
+// Each object starts with a byte holding the keyframe flag and a 
+// sequence number, so that the reader notices lost objects.
+class DeltaEncoder
+{
+public:
+    DeltaEncoder(Transport& transport, Transport::DeltaState& state)
+     : mTransport(transport),
+       mState(state),
+       mField(0)
+    {}
+    void write(uint64_t intd)
+    {
+        writeDelta(intd);
+    }
+    void write(int64_t intd)
+    {
+        writeDelta(intd);
+    }
+    void write(uint32_t intd)
+    {
+        writeDelta(intd);
+    }
+    void write(int32_t intd)
+    {
+        writeDelta(intd);
+    }
+    void write(uint16_t intd)
+    {
+        writeDelta(intd);
+    }
+    void write(int16_t intd)
+    {
+        writeDelta(intd);
+    }
+    void write(uint8_t intd)
+    {
+        writeDelta(intd);
+    }
+    void write(int8_t intd)
+    {
+        writeDelta(intd);
+    }
+    void write(float floatd)
+    {
+        mTransport.write(floatd);
+    }
+    void write(double doubled)
+    {
+        mTransport.write(doubled);
+    }
+    void write(const std::string& stringd)
+    {
+        mTransport.write(stringd);
+    }
+    template <class T> void writeArray(const T* ptr, uint32_t n)
+    {
+        for(uint32_t i = 0; i < n; ++i) {
+            write(ptr[i]);
+        }
+    }
+    template <class T> void writeChecksumed(const T& td)
+    {
+        mTransport.writeChecksumed(td);
+    }
+    bool isFunctional() const
+    {
+        return mTransport.isFunctional();
+    }
+private:
+    void writeDelta(uint64_t v)
+    {
+        if(mField == mState.values.size()) {
+            mState.values.push_back(0);
+        }
+        uint64_t& last = mState.values[mField++];
+        uint64_t delta = v - last;
+        last = v;
+        // zigzag, small negative differences get small codes too
+        mTransport.writeVarint((delta << 1) ^ (0 - (delta >> 63)));
+    }
+private:
+    Transport&             mTransport;
+    Transport::DeltaState& mState;
+    uint32_t               mField;
+};
+
+class DeltaDecoder
+{
+public:
+    DeltaDecoder(Transport& transport, Transport::DeltaState& state)
+     : mTransport(transport),
+       mState(state),
+       mField(0)
+    {}
+    void read(uint64_t& intd)
+    {
+        readDelta(intd);
+    }
+    void read(int64_t& intd)
+    {
+        readDelta(intd);
+    }
+    void read(uint32_t& intd)
+    {
+        readDelta(intd);
+    }
+    void read(int32_t& intd)
+    {
+        readDelta(intd);
+    }
+    void read(uint16_t& intd)
+    {
+        readDelta(intd);
+    }
+    void read(int16_t& intd)
+    {
+        readDelta(intd);
+    }
+    void read(uint8_t& intd)
+    {
+        readDelta(intd);
+    }
+    void read(int8_t& intd)
+    {
+        readDelta(intd);
+    }
+    void read(float& floatd)
+    {
+        mTransport.read(floatd);
+    }
+    void read(double& doubled)
+    {
+        mTransport.read(doubled);
+    }
+    void read(std::string& stringd)
+    {
+        mTransport.read(stringd);
+    }
+    bool readView(const char*& str, uint32_t& len)
+    {
+        return mTransport.readView(str, len);
+    }
+    template <class T> void readArray(T* ptr, uint32_t n)
+    {
+        for(uint32_t i = 0; i < n; ++i) {
+            read(ptr[i]);
+        }
+    }
+    template <class T> void readChecksumed(T& td)
+    {
+        mTransport.readChecksumed(td);
+    }
+    bool isFunctional() const
+    {
+        return mTransport.isFunctional();
+    }
+private:
+    template <class T> void readDelta(T& v)
+    {
+        uint64_t code;
+        if(!mTransport.readVarint(code, 10)) {
+            mTransport.setWaitSync();
+        }
+        if(mField == mState.values.size()) {
+            mState.values.push_back(0);
+        }
+        uint64_t& last = mState.values[mField++];
+        last += (code >> 1) ^ (0 - (code & 1));
+        v = (T)last;
+    }
+private:
+    Transport&             mTransport;
+    Transport::DeltaState& mState;
+    uint32_t               mField;
+};
+
+// Base for types providing template encode/decode functions instead
+// of write/read:
+//     template <class Out> void encode(Out& out) const;
+//     template <class In>  void decode(In& in);
+// The transport's codec is looked up once per object. E is the 
+// Endianness of the configuration the type is used with, only its 
+// Encoder/Decoder are instantiated; frames they can't handle inline
+// (varints, transports configured the other way) go through the 
+// Transport itself. Types registered with TYPE_CODEC_DELTA are 
+// written through DeltaEncoder.
+template<typename Type, ConfigEndianness E = ENDIAN_NATIVE>
+class Encodable : public Serializable<Type>
+{
+public:
+    virtual void write(Transport& out) const
+    {
+        const Type& self = static_cast<const Type&>(*this);
+        Transport::Codec codec = out.writeCodec();
+        if(codec == fixedCodec()) {
+            Encoder<E> encoder(out);
+            self.encode(encoder);
+        } else if(codec == Transport::CODEC_DELTA) {
+            DeltaEncoder encoder(out, out.beginWriteDelta(self.id()));
+            self.encode(encoder);
+        } else {
+            self.encode(out);
+        }
+    }
+    virtual void read(Transport& in)
+    {
+        Type& self = static_cast<Type&>(*this);
+        Transport::Codec codec = in.readCodec();
+        if(codec == fixedCodec()) {
+            Decoder<E> decoder(in);
+            self.decode(decoder);
+        } else if(codec == Transport::CODEC_DELTA) {
+            Transport::DeltaState* state = in.beginReadDelta(self.id());
+            if(state) {
+                DeltaDecoder decoder(in, *state);
+                self.decode(decoder);
+            }
+        } else {
+            self.decode(in);
+        }
+    }
+private:
+    static Transport::Codec fixedCodec()
+    {
+        return (E == ENDIAN_SWAP) ? Transport::CODEC_SWAP : Transport::CODEC_NATIVE;
+    }
+};
+
+} // namespace ygg
+
+#endif //YGG_CODEC_HPP
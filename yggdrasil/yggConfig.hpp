@@ -31,6 +31,122 @@ namespace ygg {
         ENDIAN_NATIVE,
         ENDIAN_SWAP,
     };
+    // Supported:
+    //    BATCHING_DISABLED: tested
+    //    BATCHING_ENABLED: tested, applies to NONBLOCKING serialization
+    enum ConfigBatching
+    {
+        BATCHING_DISABLED,
+        BATCHING_ENABLED
+    };
+    // Supported:
+    //    All tested, has to be the same on both ends, it isn't 
+    //    negotiated: INTEGRITY_SUM8 is what the older peers use.
+    //    The CRCs over the buffered spans cost less per byte than 
+    //    the sum used to, field by field, CRC32C least with SSE4.2, 
+    //    see asgard/mimir for the figures.
+    enum ConfigIntegrity
+    {
+        INTEGRITY_SUM8,
+        INTEGRITY_CRC16,
+        INTEGRITY_CRC32C
+    };
+    // Supported:
+    //    ENCODING_FIXED: tested
+    //    ENCODING_VARINT: tested, written only after the other end 
+    //                     announced it in its manifest
+    enum ConfigEncoding
+    {
+        ENCODING_FIXED,
+        ENCODING_VARINT
+    };
+    // Supported:
+    //    FRAMING_SYNC: tested
+    //    FRAMING_COBS: tested, has to be the same on both ends (it
+    //                  isn't negotiated), frames longer than the 
+    //                  receiver's ReadBufferSize are dropped, the 
+    //                  manifest and the batches included
+    enum ConfigFraming
+    {
+        FRAMING_SYNC,
+        FRAMING_COBS
+    };
+    // Supported:
+    //    LOG_RAW: tested
+    //    LOG_COMPRESSED: tested, reads raw logs as well
+    enum ConfigLogFormat
+    {
+        LOG_RAW,
+        LOG_COMPRESSED
+    };
+    // Supported:
+    //    SEQUENCING_DISABLED: tested
+    //    SEQUENCING_ENABLED: tested, the other end numbers its frames 
+    //                        once it got the manifest asking for it
+    enum ConfigSequencing
+    {
+        SEQUENCING_DISABLED,
+        SEQUENCING_ENABLED
+    };
+    // Supported:
+    //    VIEWS_DISABLED: tested
+    //    VIEWS_ENABLED: tested, the input handler has to provide 
+    //                   bool processView(const ygg::ObjectView&),
+    //                   it is called by the thread reading the link, 
+    //                   which need not be the one calling process(), 
+    //                   and the view is valid only during the call
+    enum ConfigViews
+    {
+        VIEWS_DISABLED,
+        VIEWS_ENABLED
+    };
+    // What a full queue does with one more object, InputOverflow
+    // and OutputOverflow select it for the NONBLOCKING queues.
+    // Supported:
+    //    OVERFLOW_DROP_NEWEST: tested, the object pushed is dropped
+    //    OVERFLOW_DROP_OLDEST: tested, the longest queued is dropped
+    //    OVERFLOW_BLOCK: tested, waits up to QueueBlockMs for room, 
+    //                    then drops the object pushed
+    //    OVERFLOW_LATEST: tested, an object replaces the queued one
+    //                     of its type, else as OVERFLOW_DROP_NEWEST
+    enum ConfigOverflow
+    {
+        OVERFLOW_DROP_NEWEST,
+        OVERFLOW_DROP_OLDEST,
+        OVERFLOW_BLOCK,
+        OVERFLOW_LATEST
+    };
+    // InputQueue selects the queue between the deserializer and the
+    // handler thread, OutputQueue the one in front of the serializer 
+    // thread, both for NONBLOCKING communication.
+    // Supported:
+    //    QUEUE_LIST: tested
+    //    QUEUE_RING: tested, also past the wrap of its counters, 
+    //                InputQueue only, an OutputQueue doesn't compile 
+    //                with it, lock-free while neither side waits, 
+    //                InputOverflow other than OVERFLOW_BLOCK 
+    //                acts as OVERFLOW_DROP_NEWEST, the slots are 
+    //                InputQueueSize rounded up to a power of two
+    //    QUEUE_MPSC: tested, lock-free for the senders, an overflow 
+    //                policy other than OVERFLOW_BLOCK acts as 
+    //                OVERFLOW_DROP_NEWEST
+    enum ConfigQueue
+    {
+        QUEUE_LIST,
+        QUEUE_RING,
+        QUEUE_MPSC
+    };
+    // Supported:
+    //    ALLOCATION_HEAP: tested
+    //    ALLOCATION_POOLED: tested, every registered type gets a pool
+    //                       of ObjectPoolSize objects at the start of
+    //                       the service, the objects past it come 
+    //                       from the heap
+    enum ConfigAllocation
+    {
+        ALLOCATION_HEAP,
+        ALLOCATION_POOLED
+    };
 
 } // namespace ygg
 
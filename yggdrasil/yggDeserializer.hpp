@@ -20,18 +20,37 @@ public:
     bool isFunctional();
     void stop();
     void sendManifestRequest();
+    // what happened to the incoming frames and objects
+    void statistics(Transport::LinkStatistics& stats) const;
     // logger accessor/mutator API 
     L&   getLogger();
     void setLogger(L& logger);
+    // nothing is written to the log device after it returns
+    void stopLogger();
 private:
     template<typename TH, ConfigCommunication>
     class Helper 
     {
     public:
         Helper(Deserializer<T,S,I,L,C>& ds);
+        uint32_t droppedObjects() const;
+        uint32_t queueHighWater() const;
     };
+    // how the objects are taken from the transport
+    template<typename TH, ConfigViews>
+    class Receiver
+    {
+    public:
+        static TypeBase* receive(Deserializer<T,S,I,L,C>& ds);
+    };
+    // the next object for the handler, NULL if there is none 
+    // or the handler took it as a view already
+    TypeBase* receive();
+    // the handler thread and the one taking views both log
+    template <class O> void log(const O& d);
 private:
     Transport&    mTransport;
+    MutexType     mLogMutex;
     L   mLogger;  
     S&  mSerializer;
     I&  mHandler;
@@ -72,7 +91,18 @@ void
 Deserializer<T,S,I,L,C>::sendManifestRequest()
 {
     mSerializer.reset();
-    mSerializer.send(TypeRegistry::extractManifest());
+    mSerializer.send(TypeRegistry::extractManifest(mTransport.supportedLinkOptions()));
+}
+
+template <typename T, typename S, typename I, typename L, typename C>
+void
+Deserializer<T,S,I,L,C>::statistics(Transport::LinkStatistics& stats) const
+{
+    mTransport.statistics(stats);
+    stats.inputQueueDrops = mHelper.droppedObjects();
+    stats.outputQueueDrops = mSerializer.droppedObjects();
+    stats.inputQueueHighWater = mHelper.queueHighWater();
+    stats.outputQueueHighWater = mSerializer.queueHighWater();
 }
 
 template <typename T, typename S, typename I, typename L, typename C>
@@ -86,10 +116,82 @@ template <typename T, typename S, typename I, typename L, typename C>
 void
 Deserializer<T,S,I,L,C>::setLogger(L& logger)
 {
-    // make sure this is thread safe!
+    mLogMutex.lock();
     mLogger.swap(logger);
+    mLogMutex.unlock();
+}
+
+template <typename T, typename S, typename I, typename L, typename C>
+void
+Deserializer<T,S,I,L,C>::stopLogger()
+{
+    mLogMutex.lock();
+    mLogger.stop();
+    mLogMutex.unlock();
+}
+
+template <typename T, typename S, typename I, typename L, typename C>
+TypeBase*
+Deserializer<T,S,I,L,C>::receive()
+{
+    return Receiver<T,C::Views>::receive(*this);
+}
+
+template <typename T, typename S, typename I, typename L, typename C>
+template <class O>
+void
+Deserializer<T,S,I,L,C>::log(const O& d)
+{
+    mLogMutex.lock();
+    mLogger.serialize(d);
+    mLogMutex.unlock();
 }
 
+/////////////////////////////////////////////////////////
+//   partial specialization of the receiver class for  //
+//   VIEWS_DISABLED configuration                      //  
+/////////////////////////////////////////////////////////
+template <typename T, typename S, typename I, typename L, typename C>
+template <typename TH>
+class Deserializer<T,S,I,L,C>::Receiver<TH,VIEWS_DISABLED>
+{
+public:
+    static TypeBase* receive(Deserializer<T,S,I,L,C>& ds)
+    {
+        TypeBase* d = NULL;
+        ds.mTransport.deserialize(d);
+        return d;
+    }
+};
+
+/////////////////////////////////////////////////////////
+//   partial specialization of the receiver class for  //
+//   VIEWS_ENABLED configuration, the handler sees     //
+//   the objects in the receive buffer first, in the   //
+//   thread reading the transport                      //  
+/////////////////////////////////////////////////////////
+template <typename T, typename S, typename I, typename L, typename C>
+template <typename TH>
+class Deserializer<T,S,I,L,C>::Receiver<TH,VIEWS_ENABLED>
+{
+public:
+    static TypeBase* receive(Deserializer<T,S,I,L,C>& ds)
+    {
+        TypeBase* d = NULL;
+        ObjectView view;
+        ds.mTransport.deserialize(d, view);
+        if(view.isValid()) {
+            if(ds.mHandler.processView(view)) {
+                ds.log(view);
+                return NULL;
+            }
+            // the handler wants an object of it
+            d = view.instantiate();
+        }
+        return d;
+    }
+};
+
 /////////////////////////////////////////////////////////
 //   partial specialization of the helper class for    //
 //   COMMUNICATION_BLOCKING configuration              //  
@@ -104,6 +206,8 @@ class Deserializer<T,S,I,L,C>::Helper<TH,COMMUNICATION_BLOCKING>
 public:
     Helper(Deserializer<T,S,I,L,C>& ds);
     void reset();
+    uint32_t droppedObjects() const;
+    uint32_t queueHighWater() const;
 private:
     Deserializer<T,S,I,L,C>& mOwner;
 };
@@ -115,14 +219,14 @@ Deserializer<T,S,I,L,C>::Helper<TH, COMMUNICATION_BLOCKING>::Helper(Deserializer
 {
     // find a proper break condition...
     while(true) {
-        TypeBase* d = NULL;
-        mOwner.mTransport.deserialize(d);
+        TypeBase* d = mOwner.receive();
         if(d == NULL) {
             continue;
         }
         if(d->id() == TypeDescriptor<ManifestDataType>::id()) {
             ManifestDataType* md = (ManifestDataType*)d;
             TypeRegistry::applyManifest(md);
+            mOwner.mTransport.acceptLinkOptions(md->mLinkOptions);
         } else
         if(d->id() == TypeDescriptor<SysCmdDataType>::id()) {
             SysCmdDataType* sd = (SysCmdDataType*)d;
@@ -133,7 +237,7 @@ Deserializer<T,S,I,L,C>::Helper<TH, COMMUNICATION_BLOCKING>::Helper(Deserializer
         if(TypeRegistry::isOwnTypeEnabled(d->id())) {
             mOwner.mHandler.process(d);
             // write the object to the log...
-            mOwner.mLogger.serialize(d);
+            mOwner.log(d);
         }
         delete d;
     }
@@ -146,6 +250,22 @@ Deserializer<T,S,I,L,C>::Helper<TH, COMMUNICATION_BLOCKING>::reset()
 {
 }
 
+template <typename T, typename S, typename I, typename L, typename C>
+template <typename TH>
+uint32_t
+Deserializer<T,S,I,L,C>::Helper<TH, COMMUNICATION_BLOCKING>::droppedObjects() const
+{
+    return 0;
+}
+
+template <typename T, typename S, typename I, typename L, typename C>
+template <typename TH>
+uint32_t
+Deserializer<T,S,I,L,C>::Helper<TH, COMMUNICATION_BLOCKING>::queueHighWater() const
+{
+    return 0;
+}
+
 
 
 /////////////////////////////////////////////////////////
@@ -160,13 +280,15 @@ class Deserializer<T,S,I,L,C>::Helper<TH,COMMUNICATION_NONBLOCKING>
     typedef typename T::MutexType    MutexType;
     typedef typename T::CondType     CondType;
     typedef typename T::ThreadType   ThreadType;
-    typedef Queue<TypeBase, MutexType, CondType> QueueType;
-    typedef typename QueueType::TypeList         QueueTypeList;
+    typedef typename QueueOf<TypeBase, MutexType, CondType, 
+                             C::InputQueue>::QueueType QueueType;
     typedef typename TypeRegistry::ManifestData  ManifestDataType;
     typedef typename TypeRegistry::SystemCmdData SysCmdDataType;
 public:
     Helper(Deserializer<T,S,I,L,C>& ds);
     void reset();
+    uint32_t droppedObjects() const;
+    uint32_t queueHighWater() const;
     static bool deserializerFunc(void*);
     static bool inputHanderFunc(void*);
 private:
@@ -180,7 +302,7 @@ template <typename T, typename S, typename I, typename L, typename C>
 template <typename TH>
 Deserializer<T,S,I,L,C>::Helper<TH, COMMUNICATION_NONBLOCKING>::Helper(Deserializer<T,S,I,L,C>& ds)
   : mOwner(ds),
-    mInputQueue(C::InputQueueSize),
+    mInputQueue(C::InputQueueSize, C::InputOverflow, C::QueueBlockMs),
     mDeserializer("Deserializer", 1536, C::BasePriority+1, deserializerFunc, NULL, this),
     mHandlerThread("InputHandler", 1536, C::BasePriority+2, inputHanderFunc, NULL, this)
 {
@@ -194,16 +316,33 @@ Deserializer<T,S,I,L,C>::Helper<TH, COMMUNICATION_NONBLOCKING>::reset()
     mOwner.mInputQueue.clear();
 }
 
+template <typename T, typename S, typename I, typename L, typename C>
+template <typename TH>
+uint32_t
+Deserializer<T,S,I,L,C>::Helper<TH, COMMUNICATION_NONBLOCKING>::droppedObjects() const
+{
+    return mInputQueue.drops();
+}
+
+template <typename T, typename S, typename I, typename L, typename C>
+template <typename TH>
+uint32_t
+Deserializer<T,S,I,L,C>::Helper<TH, COMMUNICATION_NONBLOCKING>::queueHighWater() const
+{
+    return mInputQueue.highWater();
+}
+
 template <typename T, typename S, typename I, typename L, typename C>
 template <typename TH>
 bool 
 Deserializer<T,S,I,L,C>::Helper<TH, COMMUNICATION_NONBLOCKING>::deserializerFunc(void* param)
 {
     Helper<TH,COMMUNICATION_NONBLOCKING>* h = (Helper<TH,COMMUNICATION_NONBLOCKING>*)param;
-    TypeBase* d = NULL;
-    h->mOwner.mTransport.deserialize(d);
+    TypeBase* d = h->mOwner.receive();
     if(d != NULL) {
         assert(TypeRegistry::isOwnTypeEnabled(d->id())); 
+        // if the handler doesn't keep up the queue drops
+        // objects as its policy says
         h->mInputQueue.push(d);
     }    
     return false;
@@ -215,29 +354,25 @@ bool
 Deserializer<T,S,I,L,C>::Helper<TH, COMMUNICATION_NONBLOCKING>::inputHanderFunc(void* param)
 {
     Helper<TH,COMMUNICATION_NONBLOCKING>* h = (Helper<TH,COMMUNICATION_NONBLOCKING>*)param;
-    QueueTypeList dlist;
-    h->mInputQueue.popAll(dlist);
-    typename QueueTypeList::iterator it = dlist.begin();
-    typename QueueTypeList::iterator eit = dlist.end();
-    for(; it != eit; ++it) {
-        TypeBase* d = *it;
-        if(d->id() == TypeDescriptor<ManifestDataType>::id()) {
-            ManifestDataType* md = (ManifestDataType*)d;
-            TypeRegistry::applyManifest(md);
-        } else
-        if(d->id() == TypeDescriptor<SysCmdDataType>::id()) {
-            SysCmdDataType* sd = (SysCmdDataType*)d;
-            if(*sd == SysCmdDataType::CMD_MANIFEST_REQUEST) {
-                h->mOwner.sendManifestRequest();
-            }
-        } else
-        if(TypeRegistry::isOwnTypeEnabled(d->id())) {
-            h->mOwner.mHandler.process(d);
-            // write the object to the log...
-            h->mOwner.mLogger.serialize(d);
+    // one at a time, the ring hands them out without allocating
+    TypeBase* d = h->mInputQueue.pop();
+    if(d->id() == TypeDescriptor<ManifestDataType>::id()) {
+        ManifestDataType* md = (ManifestDataType*)d;
+        TypeRegistry::applyManifest(md);
+        h->mOwner.mTransport.acceptLinkOptions(md->mLinkOptions);
+    } else
+    if(d->id() == TypeDescriptor<SysCmdDataType>::id()) {
+        SysCmdDataType* sd = (SysCmdDataType*)d;
+        if(*sd == SysCmdDataType::CMD_MANIFEST_REQUEST) {
+            h->mOwner.sendManifestRequest();
         }
-        delete d;
+    } else
+    if(TypeRegistry::isOwnTypeEnabled(d->id())) {
+        h->mOwner.mHandler.process(d);
+        // write the object to the log...
+        h->mOwner.log(d);
     }
+    delete d;
     return false;
 }
 
@@ -0,0 +1,442 @@
+#ifndef YGG_FIELDS_HPP
+#define YGG_FIELDS_HPP
+
+#include "yggCodec.hpp"
+#include <string>
+#include <cstring>
+
+namespace ygg
+{
+
+// Field lists describe the serialized layout of a type once, its
+// read/write, size and debug printing are generated from it:
+//
+//     class PingData : public ygg::Record<PingData>
+//     {
+//         ...
+//     public:
+//         typedef ygg::Fields<
+//             ygg::Field<PingData, uint32_t, &PingData::mTimeStamp>
+//         > Fields;
+//     };
+//
+// Fields are written in the order of the list. Field types are the
+// integers, float, double, std::string, arrays of these and structs
+// with a field list of their own (T::Fields or FieldsOf<T>).
+
+template <bool B> struct FieldBool {};
+
+// Field list of a struct, specialize it for the types that can't
+// have a Fields typedef of their own.
+template <class T>
+struct FieldsOf
+{
+    typedef typename T::Fields Type;
+};
+
+// Opt-in for types whose fields lie back to back in memory in the
+// order of the list. With the host byte order on the wire the fields
+// are then stored and loaded with one memcpy. Whether they really do
+// is checked on the object, a type that doesn't fit falls back to the
+// field by field coding.
+template <class T>
+struct PlainLayout
+{
+    enum
+    {
+        VALUE = false
+    };
+};
+
+// How a field type is coded:
+//     SIZE  - its serialized size in bytes, of the fixed part only
+//             when FIXED is false
+//     FIXED - all the bytes are known at compile time, the objects can
+//             be stored to the buffer in one go
+template <class T>
+struct FieldType
+{
+    typedef typename FieldsOf<T>::Type Fields;
+    enum
+    {
+        SIZE  = Fields::SIZE,
+        FIXED = Fields::FIXED
+    };
+    template <class Out> static void encode(Out& out, const T& v)
+    {
+        Fields::encode(out, v);
+    }
+    template <class In> static void decode(In& in, T& v)
+    {
+        Fields::decode(in, v);
+    }
+    template <ConfigEndianness E> static void store(uint8_t*& ptr, const T& v)
+    {
+        store<E>(ptr, v, FieldBool<E == ENDIAN_NATIVE && PlainLayout<T>::VALUE>());
+    }
+    template <ConfigEndianness E> static void load(const uint8_t*& ptr, T& v)
+    {
+        load<E>(ptr, v, FieldBool<E == ENDIAN_NATIVE && PlainLayout<T>::VALUE>());
+    }
+    // the serialized bytes are in memory as they are, in the host order
+    static bool isContiguous(const T& v)
+    {
+        return SIZE != 0 && Fields::isContiguous(v, Fields::address(v));
+    }
+    template <class Os> static void print(Os& os, const T& v)
+    {
+        os << "{";
+        Fields::print(os, v);
+        os << "}";
+    }
+private:
+    template <ConfigEndianness E> static void store(uint8_t*& ptr, const T& v, FieldBool<true>)
+    {
+        if(isContiguous(v)) {
+            memcpy(ptr, Fields::address(v), SIZE);
+            ptr += SIZE;
+        } else {
+            Fields::template store<E>(ptr, v);
+        }
+    }
+    template <ConfigEndianness E> static void store(uint8_t*& ptr, const T& v, FieldBool<false>)
+    {
+        Fields::template store<E>(ptr, v);
+    }
+    template <ConfigEndianness E> static void load(const uint8_t*& ptr, T& v, FieldBool<true>)
+    {
+        if(isContiguous(v)) {
+            memcpy((uint8_t*)Fields::address(v), ptr, SIZE);
+            ptr += SIZE;
+        } else {
+            Fields::template load<E>(ptr, v);
+        }
+    }
+    template <ConfigEndianness E> static void load(const uint8_t*& ptr, T& v, FieldBool<false>)
+    {
+        Fields::template load<E>(ptr, v);
+    }
+};
+
+template <class T>
+struct PrimitiveFieldType
+{
+    enum
+    {
+        SIZE  = sizeof(T),
+        FIXED = true
+    };
+    template <class Out> static void encode(Out& out, const T& v)
+    {
+        out.write(v);
+    }
+    template <class In> static void decode(In& in, T& v)
+    {
+        in.read(v);
+    }
+    template <ConfigEndianness E> static void store(uint8_t*& ptr, const T& v)
+    {
+        Encoder<E>::store(ptr, v);
+    }
+    template <ConfigEndianness E> static void load(const uint8_t*& ptr, T& v)
+    {
+        Decoder<E>::load(ptr, v);
+    }
+    static bool isContiguous(const T&)
+    {
+        return true;
+    }
+    template <class Os> static void print(Os& os, const T& v)
+    {
+        os << v;
+    }
+};
+
+template <> struct FieldType<uint64_t> : PrimitiveFieldType<uint64_t> {};
+template <> struct FieldType<int64_t>  : PrimitiveFieldType<int64_t>  {};
+template <> struct FieldType<uint32_t> : PrimitiveFieldType<uint32_t> {};
+template <> struct FieldType<int32_t>  : PrimitiveFieldType<int32_t>  {};
+template <> struct FieldType<uint16_t> : PrimitiveFieldType<uint16_t> {};
+template <> struct FieldType<int16_t>  : PrimitiveFieldType<int16_t>  {};
+template <> struct FieldType<float>    : PrimitiveFieldType<float>    {};
+template <> struct FieldType<double>   : PrimitiveFieldType<double>   {};
+template <> struct FieldType<uint8_t> : PrimitiveFieldType<uint8_t>
+{
+    // not as a character
+    template <class Os> static void print(Os& os, const uint8_t& v)
+    {
+        os << (uint32_t)v;
+    }
+};
+template <> struct FieldType<int8_t> : PrimitiveFieldType<int8_t>
+{
+    template <class Os> static void print(Os& os, const int8_t& v)
+    {
+        os << (int32_t)v;
+    }
+};
+
+template <>
+struct FieldType<std::string>
+{
+    enum
+    {
+        SIZE  = 0,
+        FIXED = false
+    };
+    template <class Out> static void encode(Out& out, const std::string& v)
+    {
+        out.write(v);
+    }
+    template <class In> static void decode(In& in, std::string& v)
+    {
+        in.read(v);
+    }
+    static bool isContiguous(const std::string&)
+    {
+        return false;
+    }
+    template <class Os> static void print(Os& os, const std::string& v)
+    {
+        os << "\"" << v << "\"";
+    }
+};
+
+// arrays of integers and floating points only, as readArray/writeArray
+template <class T, uint32_t N>
+struct FieldType<T[N]>
+{
+    enum
+    {
+        SIZE  = N * FieldType<T>::SIZE,
+        FIXED = FieldType<T>::FIXED
+    };
+    template <class Out> static void encode(Out& out, const T (&v)[N])
+    {
+        out.writeArray(v, N);
+    }
+    template <class In> static void decode(In& in, T (&v)[N])
+    {
+        in.readArray(v, N);
+    }
+    template <ConfigEndianness E> static void store(uint8_t*& ptr, const T (&v)[N])
+    {
+        for(uint32_t i = 0; i < N; ++i) {
+            FieldType<T>::template store<E>(ptr, v[i]);
+        }
+    }
+    template <ConfigEndianness E> static void load(const uint8_t*& ptr, T (&v)[N])
+    {
+        for(uint32_t i = 0; i < N; ++i) {
+            FieldType<T>::template load<E>(ptr, v[i]);
+        }
+    }
+    static bool isContiguous(const T (&v)[N])
+    {
+        return sizeof(T) == FieldType<T>::SIZE && FieldType<T>::isContiguous(v[0]);
+    }
+    template <class Os> static void print(Os& os, const T (&v)[N])
+    {
+        os << "[";
+        for(uint32_t i = 0; i < N; ++i) {
+            os << (i ? ", " : "");
+            FieldType<T>::print(os, v[i]);
+        }
+        os << "]";
+    }
+};
+
+// a member M of type F of the struct R
+template <class R, class F, F R::*M>
+struct Field
+{
+    typedef F Value;
+    enum
+    {
+        SIZE  = FieldType<F>::SIZE,
+        FIXED = FieldType<F>::FIXED
+    };
+    template <class Out> static void encode(Out& out, const R& r)
+    {
+        FieldType<F>::encode(out, r.*M);
+    }
+    template <class In> static void decode(In& in, R& r)
+    {
+        FieldType<F>::decode(in, r.*M);
+    }
+    template <ConfigEndianness E> static void store(uint8_t*& ptr, const R& r)
+    {
+        FieldType<F>::template store<E>(ptr, r.*M);
+    }
+    template <ConfigEndianness E> static void load(const uint8_t*& ptr, R& r)
+    {
+        FieldType<F>::template load<E>(ptr, r.*M);
+    }
+    static const uint8_t* address(const R& r)
+    {
+        return (const uint8_t*)&(r.*M);
+    }
+    // the field is at ptr and contiguous itself
+    static bool isContiguous(const R& r, const uint8_t* ptr)
+    {
+        return address(r) == ptr && FieldType<F>::isContiguous(r.*M);
+    }
+    template <class Os> static void print(Os& os, const R& r)
+    {
+        FieldType<F>::print(os, r.*M);
+    }
+};
+
+struct NoField {};
+
+// up to 8 fields, the list is a Field followed by Fields of the rest
+template <class F1,                class F2 = NoField, class F3 = NoField,
+          class F4 = NoField, class F5 = NoField, class F6 = NoField,
+          class F7 = NoField, class F8 = NoField>
+struct Fields
+{
+    typedef F1 First;
+    typedef Fields<F2, F3, F4, F5, F6, F7, F8> Rest;
+    enum
+    {
+        COUNT = 1 + Rest::COUNT,
+        SIZE  = F1::SIZE + Rest::SIZE,
+        FIXED = F1::FIXED && Rest::FIXED
+    };
+    template <class Out, class R> static void encode(Out& out, const R& r)
+    {
+        F1::encode(out, r);
+        Rest::encode(out, r);
+    }
+    template <class In, class R> static void decode(In& in, R& r)
+    {
+        F1::decode(in, r);
+        Rest::decode(in, r);
+    }
+    template <ConfigEndianness E, class R> static void store(uint8_t*& ptr, const R& r)
+    {
+        F1::template store<E>(ptr, r);
+        Rest::template store<E>(ptr, r);
+    }
+    template <ConfigEndianness E, class R> static void load(const uint8_t*& ptr, R& r)
+    {
+        F1::template load<E>(ptr, r);
+        Rest::template load<E>(ptr, r);
+    }
+    template <class R> static const uint8_t* address(const R& r)
+    {
+        return F1::address(r);
+    }
+    template <class R> static bool isContiguous(const R& r, const uint8_t* ptr)
+    {
+        return F1::isContiguous(r, ptr) && Rest::isContiguous(r, ptr + F1::SIZE);
+    }
+    template <class Os, class R> static void print(Os& os, const R& r)
+    {
+        F1::print(os, r);
+        if(Rest::COUNT != 0) {
+            os << ", ";
+        }
+        Rest::print(os, r);
+    }
+};
+
+template <>
+struct Fields<NoField>
+{
+    enum
+    {
+        COUNT = 0,
+        SIZE  = 0,
+        FIXED = true
+    };
+    template <class Out, class R> static void encode(Out&, const R&)
+    {}
+    template <class In, class R> static void decode(In&, R&)
+    {}
+    template <ConfigEndianness E, class R> static void store(uint8_t*&, const R&)
+    {}
+    template <ConfigEndianness E, class R> static void load(const uint8_t*&, R&)
+    {}
+    template <class R> static const uint8_t* address(const R&)
+    {
+        return NULL;
+    }
+    template <class R> static bool isContiguous(const R&, const uint8_t*)
+    {
+        return true;
+    }
+    template <class Os, class R> static void print(Os&, const R&)
+    {}
+};
+
+// Base for types described by a field list. With the compile-time
+// codecs a fixed size type reserves its bytes in the buffer once and
+// stores the fields without further checks, otherwise (and when the
+// buffer has no room) the fields go one by one. E as for Encodable.
+template<typename Type, ConfigEndianness E = ENDIAN_NATIVE>
+class Record : public Encodable<Type, E>
+{
+public:
+    template <class Out> void encode(Out& out) const
+    {
+        FieldType<Type>::encode(out, self());
+    }
+    void encode(Encoder<E>& out) const
+    {
+        encodeFixed(out, FieldBool<FieldType<Type>::FIXED>());
+    }
+    template <class In> void decode(In& in)
+    {
+        FieldType<Type>::decode(in, self());
+    }
+    void decode(Decoder<E>& in)
+    {
+        decodeFixed(in, FieldBool<FieldType<Type>::FIXED>());
+    }
+    // prints the field values, to any stream with operator<<
+    template <class Os> void print(Os& os) const
+    {
+        FieldType<Type>::print(os, self());
+    }
+
+private:
+    const Type& self() const
+    {
+        return static_cast<const Type&>(*this);
+    }
+    Type& self()
+    {
+        return static_cast<Type&>(*this);
+    }
+    void encodeFixed(Encoder<E>& out, FieldBool<true>) const
+    {
+        uint8_t* ptr = out.reserve(FieldType<Type>::SIZE);
+        if(ptr) {
+            FieldType<Type>::template store<E>(ptr, self());
+        } else {
+            FieldType<Type>::encode(out, self());
+        }
+    }
+    void encodeFixed(Encoder<E>& out, FieldBool<false>) const
+    {
+        FieldType<Type>::encode(out, self());
+    }
+    void decodeFixed(Decoder<E>& in, FieldBool<true>)
+    {
+        const uint8_t* ptr = in.consume(FieldType<Type>::SIZE);
+        if(ptr) {
+            FieldType<Type>::template load<E>(ptr, self());
+        } else {
+            FieldType<Type>::decode(in, self());
+        }
+    }
+    void decodeFixed(Decoder<E>& in, FieldBool<false>)
+    {
+        FieldType<Type>::decode(in, self());
+    }
+};
+
+} // namespace ygg
+
+#endif //YGG_FIELDS_HPP
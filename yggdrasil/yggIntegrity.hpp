@@ -0,0 +1,183 @@
+#ifndef YGG_INTEGRITY_HPP
+#define YGG_INTEGRITY_HPP
+
+#include "yggConfig.hpp"
+#include <stdint.h>
+#include <string.h>
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+namespace ygg
+{
+
+// Frame integrity checks selected with ConfigIntegrity. The running
+// value starts with initial(), is updated over any number of byte
+// spans with update() and value() gives what is sent on the wire.
+template <ConfigIntegrity I>
+class Integrity
+{
+};
+
+/////////////////////////////////////////////////////////
+//   8-bit sum of all the bytes                        //
+/////////////////////////////////////////////////////////
+template <>
+class Integrity<INTEGRITY_SUM8>
+{
+public:
+    typedef uint8_t ValueType;
+public:
+    static uint32_t initial()
+    {
+        return 0;
+    }
+    static uint32_t update(uint32_t v, const void* ptr, uint32_t size)
+    {
+        const uint8_t* bptr = (const uint8_t*)ptr;
+        for(uint32_t i = 0; i < size; ++i) {
+            v += bptr[i];
+        }
+        return v;
+    }
+    static ValueType value(uint32_t v)
+    {
+        return (ValueType)v;
+    }
+};
+
+/////////////////////////////////////////////////////////
+//   CRC-16-CCITT (poly 0x1021, init 0xFFFF),          //
+//   slicing-by-8                                      //
+/////////////////////////////////////////////////////////
+template <>
+class Integrity<INTEGRITY_CRC16>
+{
+    struct Tables
+    {
+        Tables()
+        {
+            for(uint32_t b = 0; b < 256; ++b) {
+                uint16_t crc = b << 8;
+                for(uint32_t i = 0; i < 8; ++i) {
+                    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+                }
+                t[0][b] = crc;
+            }
+            // t[k][b] is the crc of b followed by k zero bytes
+            for(uint32_t k = 1; k < 8; ++k) {
+                for(uint32_t b = 0; b < 256; ++b) {
+                    t[k][b] = (t[k-1][b] << 8) ^ t[0][t[k-1][b] >> 8];
+                }
+            }
+        }
+        uint16_t t[8][256];
+    };
+    static const Tables& tables()
+    {
+        static Tables sTables;
+        return sTables;
+    }
+public:
+    typedef uint16_t ValueType;
+public:
+    static uint32_t initial()
+    {
+        return 0xFFFF;
+    }
+    static uint32_t update(uint32_t v, const void* ptr, uint32_t size)
+    {
+        const uint16_t (*t)[256] = tables().t;
+        const uint8_t* bptr = (const uint8_t*)ptr;
+        uint16_t crc = v;
+        for(; size >= 8; size -= 8, bptr += 8) {
+            crc = t[7][bptr[0] ^ (crc >> 8)] ^ t[6][bptr[1] ^ (crc & 0xFF)] ^
+                  t[5][bptr[2]] ^ t[4][bptr[3]] ^ t[3][bptr[4]] ^
+                  t[2][bptr[5]] ^ t[1][bptr[6]] ^ t[0][bptr[7]];
+        }
+        for(; size; --size, ++bptr) {
+            crc = (crc << 8) ^ t[0][(crc >> 8) ^ *bptr];
+        }
+        return crc;
+    }
+    static ValueType value(uint32_t v)
+    {
+        return (ValueType)v;
+    }
+};
+
+/////////////////////////////////////////////////////////
+//   CRC-32C (Castagnoli, reflected poly 0x82F63B78),  //
+//   SSE4.2 crc32 instruction or slicing-by-8          //
+/////////////////////////////////////////////////////////
+template <>
+class Integrity<INTEGRITY_CRC32C>
+{
+    struct Tables
+    {
+        Tables()
+        {
+            for(uint32_t b = 0; b < 256; ++b) {
+                uint32_t crc = b;
+                for(uint32_t i = 0; i < 8; ++i) {
+                    crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78 : (crc >> 1);
+                }
+                t[0][b] = crc;
+            }
+            // t[k][b] is the crc of b followed by k zero bytes
+            for(uint32_t k = 1; k < 8; ++k) {
+                for(uint32_t b = 0; b < 256; ++b) {
+                    t[k][b] = (t[k-1][b] >> 8) ^ t[0][t[k-1][b] & 0xFF];
+                }
+            }
+        }
+        uint32_t t[8][256];
+    };
+    static const Tables& tables()
+    {
+        static Tables sTables;
+        return sTables;
+    }
+public:
+    typedef uint32_t ValueType;
+public:
+    static uint32_t initial()
+    {
+        return 0xFFFFFFFF;
+    }
+    static uint32_t update(uint32_t v, const void* ptr, uint32_t size)
+    {
+        const uint8_t* bptr = (const uint8_t*)ptr;
+        uint32_t crc = v;
+#if defined(__SSE4_2__) && defined(__x86_64__)
+        for(; size >= 8; size -= 8, bptr += 8) {
+            uint64_t word;
+            memcpy(&word, bptr, sizeof(word));
+            crc = (uint32_t)_mm_crc32_u64(crc, word);
+        }
+        for(; size; --size, ++bptr) {
+            crc = _mm_crc32_u8(crc, *bptr);
+        }
+#else
+        const uint32_t (*t)[256] = tables().t;
+        for(; size >= 8; size -= 8, bptr += 8) {
+            uint32_t lo = crc ^ (bptr[0] | (bptr[1] << 8) | (bptr[2] << 16) | ((uint32_t)bptr[3] << 24));
+            crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^
+                  t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+                  t[3][bptr[4]] ^ t[2][bptr[5]] ^ t[1][bptr[6]] ^ t[0][bptr[7]];
+        }
+        for(; size; --size, ++bptr) {
+            crc = (crc >> 8) ^ t[0][(crc ^ *bptr) & 0xFF];
+        }
+#endif
+        return crc;
+    }
+    static ValueType value(uint32_t v)
+    {
+        return ~v;
+    }
+};
+
+} // namespace ygg
+
+#endif //YGG_INTEGRITY_HPP
@@ -0,0 +1,296 @@
+#ifndef YGG_LOG_DEVICE_HPP
+#define YGG_LOG_DEVICE_HPP
+
+#include "yggConfig.hpp"
+#include "yggBaseTypes.hpp"
+#include "yggLz.hpp"
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+namespace ygg
+{
+
+// Device the logger writes through and the replay reads from,
+// wraps the device of the log file.
+template <typename D, ConfigLogFormat F>
+class LogDevice
+{
+};
+
+/////////////////////////////////////////////////////////
+//   LOG_RAW: the frames go to the file as they are    //
+/////////////////////////////////////////////////////////
+template <typename D>
+class LogDevice<D, LOG_RAW>
+{
+public:
+    typedef uint64_t (*Clock)();
+public:
+    // same as for LOG_COMPRESSED, the frames go out right away
+    LogDevice(D* device = NULL, Clock = NULL, uint32_t = 0)
+     : mDevice(device)
+    {}
+    bool isOpen()
+    {
+        return mDevice && mDevice->isOpen();
+    }
+    bool write(const void* ptr, uint32_t size)
+    {
+        return mDevice->write(ptr, size);
+    }
+    bool write(const IoChunk* chunks, uint32_t count)
+    {
+        return mDevice->write(chunks, count);
+    }
+    uint32_t readSome(void* ptr, uint32_t size)
+    {
+        return mDevice->readSome(ptr, size);
+    }
+    void flush()
+    {}
+private:
+    D* mDevice;
+};
+
+/////////////////////////////////////////////////////////
+//   LOG_COMPRESSED: the frames are collected in       //
+//   blocks compressed one by one                      //
+/////////////////////////////////////////////////////////
+// The file starts with "YGGZ", every block has a header:
+//     'Y' 'B' | raw size (32-bit LE) | stored size (32-bit LE) | sum
+// followed by the stored bytes, compressed with Lz unless the two
+// sizes are equal. Blocks don't depend on each other, a reader can
+// start at any block header. Files without the magic are read as
+// raw logs. A block is closed when it is full, at flush() and, with
+// a clock (microseconds), by the first write after it got older than
+// maxBlockMs: a capture loses at most that much when it is killed.
+template <typename D>
+class LogDevice<D, LOG_COMPRESSED>
+{
+public:
+    typedef uint64_t (*Clock)();
+    enum
+    {
+        BLOCK_SIZE = Lz::WINDOW_SIZE,
+        BLOCK_MS = 1000
+    };
+public:
+    LogDevice(D* device = NULL, Clock clock = NULL, 
+              uint32_t maxBlockMs = BLOCK_MS)
+     : mDevice(device),
+       mState(STATE_START),
+       mReadPos(0),
+       mClock(clock),
+       mMaxBlockUs((uint64_t)maxBlockMs * 1000),
+       mBlockBegin(0)
+    {}
+    ~LogDevice()
+    {
+        flush();
+    }
+    bool isOpen()
+    {
+        return mDevice && mDevice->isOpen();
+    }
+    bool write(const void* ptr, uint32_t size)
+    {
+        if(mState == STATE_START) {
+            mState = STATE_WRITING;
+            if(!mDevice->write(MAGIC, sizeof(MAGIC))) {
+                return false;
+            }
+        }
+        const uint8_t* bptr = (const uint8_t*)ptr;
+        while(size) {
+            if(mBlock.empty() && mClock) {
+                mBlockBegin = mClock();
+            }
+            uint32_t chunk = std::min(size, (uint32_t)BLOCK_SIZE - (uint32_t)mBlock.size());
+            mBlock.insert(mBlock.end(), bptr, bptr + chunk);
+            bptr += chunk;
+            size -= chunk;
+            if(mBlock.size() == BLOCK_SIZE && !writeBlock()) {
+                return false;
+            }
+        }
+        if(!mBlock.empty() && mClock && mClock() - mBlockBegin >= mMaxBlockUs) {
+            return writeBlock();
+        }
+        return true;
+    }
+    bool write(const IoChunk* chunks, uint32_t count)
+    {
+        for(uint32_t i = 0; i < count; ++i) {
+            if(!write(chunks[i].ptr, chunks[i].size)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    uint32_t readSome(void* ptr, uint32_t size)
+    {
+        if(mState == STATE_START && !readStart()) {
+            return 0;
+        }
+        if(mState == STATE_RAW && mReadPos == mBlock.size()) {
+            return mDevice->readSome(ptr, size);
+        }
+        while(mReadPos == mBlock.size()) {
+            if(!readBlock()) {
+                return 0;
+            }
+        }
+        uint32_t chunk = std::min(size, (uint32_t)mBlock.size() - mReadPos);
+        memcpy(ptr, &mBlock[mReadPos], chunk);
+        mReadPos += chunk;
+        return chunk;
+    }
+    // writes out the collected frames as a block
+    void flush()
+    {
+        if(mState == STATE_WRITING && !mBlock.empty()) {
+            writeBlock();
+        }
+    }
+
+private:
+    enum State
+    {
+        STATE_START,
+        STATE_WRITING,
+        STATE_RAW,
+        STATE_COMPRESSED
+    };
+    enum
+    {
+        HEADER_SIZE = 11
+    };
+    static const uint8_t MAGIC[4];
+
+    bool writeBlock()
+    {
+        uint32_t size = mBlock.size();
+        mPacked.resize(HEADER_SIZE + Lz::bound(size));
+        uint32_t stored = Lz::compress(&mBlock[0], size, &mPacked[HEADER_SIZE]);
+        if(stored >= size) {
+            // doesn't compress, store it as it is
+            memcpy(&mPacked[HEADER_SIZE], &mBlock[0], size);
+            stored = size;
+        }
+        uint8_t* header = &mPacked[0];
+        header[0] = 'Y';
+        header[1] = 'B';
+        writeLE32(header + 2, size);
+        writeLE32(header + 6, stored);
+        header[10] = 255 - sum(header, 10);
+        mBlock.clear();
+        return mDevice->write(&mPacked[0], HEADER_SIZE + stored);
+    }
+    bool readStart()
+    {
+        // tell a compressed log from a raw one by its first bytes
+        mBlock.resize(sizeof(MAGIC));
+        uint32_t size = readFully(&mBlock[0], sizeof(MAGIC));
+        mBlock.resize(size);
+        mReadPos = 0;
+        if(size == sizeof(MAGIC) && memcmp(&mBlock[0], MAGIC, size) == 0) {
+            mBlock.clear();
+            mState = STATE_COMPRESSED;
+        } else {
+            // the bytes read so far are handed out first
+            mState = STATE_RAW;
+        }
+        return size != 0;
+    }
+    bool readBlock()
+    {
+        mBlock.clear();
+        mReadPos = 0;
+        uint8_t header[HEADER_SIZE];
+        if(readFully(header, HEADER_SIZE) != HEADER_SIZE) {
+            return false;
+        }
+        // a broken header, slide until the next valid one
+        while(!isHeader(header)) {
+            memmove(header, header + 1, HEADER_SIZE - 1);
+            if(readFully(header + HEADER_SIZE - 1, 1) != 1) {
+                return false;
+            }
+        }
+        uint32_t size = readLE32(header + 2);
+        uint32_t stored = readLE32(header + 6);
+        mPacked.resize(stored);
+        if(readFully(&mPacked[0], stored) != stored) {
+            return false;
+        }
+        mBlock.resize(size);
+        if(stored == size) {
+            memcpy(&mBlock[0], &mPacked[0], size);
+        } else if(!Lz::decompress(&mPacked[0], stored, &mBlock[0], size)) {
+            // the frames in it are lost, go on with the next block
+            mBlock.clear();
+        }
+        return true;
+    }
+    static bool isHeader(const uint8_t* header)
+    {
+        if(header[0] != 'Y' || header[1] != 'B' || sum(header, HEADER_SIZE) != 255) {
+            return false;
+        }
+        uint32_t size = readLE32(header + 2);
+        uint32_t stored = readLE32(header + 6);
+        return size <= BLOCK_SIZE && stored != 0 && stored <= size;
+    }
+    uint32_t readFully(uint8_t* ptr, uint32_t size)
+    {
+        uint32_t done = 0;
+        while(done < size) {
+            uint32_t bytesRead = mDevice->readSome(ptr + done, size - done);
+            if(bytesRead == 0) {
+                break;
+            }
+            done += bytesRead;
+        }
+        return done;
+    }
+    static uint8_t sum(const uint8_t* ptr, uint32_t size)
+    {
+        uint8_t s = 0;
+        for(uint32_t i = 0; i < size; ++i) {
+            s += ptr[i];
+        }
+        return s;
+    }
+    static void writeLE32(uint8_t* ptr, uint32_t v)
+    {
+        ptr[0] = (uint8_t)v;
+        ptr[1] = (uint8_t)(v >> 8);
+        ptr[2] = (uint8_t)(v >> 16);
+        ptr[3] = (uint8_t)(v >> 24);
+    }
+    static uint32_t readLE32(const uint8_t* ptr)
+    {
+        return ptr[0] | (ptr[1] << 8) | (ptr[2] << 16) | ((uint32_t)ptr[3] << 24);
+    }
+
+private:
+    D*                   mDevice;
+    State                mState;
+    // raw bytes of the block being written or read
+    std::vector<uint8_t> mBlock;
+    std::vector<uint8_t> mPacked;
+    uint32_t             mReadPos;
+    Clock                mClock;
+    uint64_t             mMaxBlockUs;
+    // when the first bytes of the block being written came
+    uint64_t             mBlockBegin;
+};
+
+template <typename D>
+const uint8_t LogDevice<D, LOG_COMPRESSED>::MAGIC[4] = { 'Y', 'G', 'G', 'Z' };
+
+} // namespace ygg
+
+#endif //YGG_LOG_DEVICE_HPP
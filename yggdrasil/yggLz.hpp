@@ -0,0 +1,184 @@
+#ifndef YGG_LZ_HPP
+#define YGG_LZ_HPP
+
+#include <stdint.h>
+#include <string.h>
+
+namespace ygg
+{
+
+// Byte oriented LZ77 compression in the LZ4 block format: a token with
+// the literal and match lengths, the literals, a 16-bit match offset.
+// Every block is compressed on its own, matches never reach outside.
+class Lz
+{
+public:
+    enum
+    {
+        // matches can't reach further back
+        WINDOW_SIZE = 65536
+    };
+public:
+    // the most compress() can produce for size bytes
+    static uint32_t bound(uint32_t size)
+    {
+        return size + size / 255 + 16;
+    }
+    // returns the compressed size, dst has to hold bound(size) bytes
+    static uint32_t compress(const void* src, uint32_t size, void* dst)
+    {
+        const uint8_t* in = (const uint8_t*)src;
+        uint8_t* out = (uint8_t*)dst;
+        uint8_t* op = out;
+        // last position seen for each hash, offset by one, 0 is empty
+        uint32_t table[HASH_SIZE];
+        memset(table, 0, sizeof(table));
+        uint32_t anchor = 0;
+        uint32_t ip = 0;
+        // the format wants the last 5 bytes as literals and
+        // no match starting in the last 12
+        uint32_t matchLimit = (size > LAST_LITERALS) ? size - LAST_LITERALS : 0;
+        uint32_t searchLimit = (size > MIN_TAIL) ? size - MIN_TAIL : 0;
+        while(ip < searchLimit) {
+            uint32_t seq = read32(in + ip);
+            uint32_t h = hash(seq);
+            uint32_t ref = table[h];
+            table[h] = ip + 1;
+            if(ref == 0 || ip + 1 - ref > WINDOW_SIZE - 1 || read32(in + ref - 1) != seq) {
+                ++ip;
+                continue;
+            }
+            --ref;
+            uint32_t len = MIN_MATCH;
+            while(ip + len < matchLimit && in[ref + len] == in[ip + len]) {
+                ++len;
+            }
+            op = writeSequence(op, in + anchor, ip - anchor, ip - ref, len);
+            ip += len;
+            anchor = ip;
+        }
+        op = writeLiterals(op, in + anchor, size - anchor);
+        return op - out;
+    }
+    // returns false if src is not exactly size bytes once decompressed
+    static bool decompress(const void* src, uint32_t srcSize, void* dst, uint32_t size)
+    {
+        const uint8_t* ip = (const uint8_t*)src;
+        const uint8_t* iend = ip + srcSize;
+        uint8_t* out = (uint8_t*)dst;
+        uint8_t* op = out;
+        uint8_t* oend = out + size;
+        while(ip < iend) {
+            uint32_t token = *ip++;
+            uint32_t lit = token >> 4;
+            if(lit == 15 && !readLength(ip, iend, lit)) {
+                return false;
+            }
+            if(lit > (uint32_t)(iend - ip) || lit > (uint32_t)(oend - op)) {
+                return false;
+            }
+            memcpy(op, ip, lit);
+            ip += lit;
+            op += lit;
+            if(ip == iend) {
+                // the last sequence has literals only
+                break;
+            }
+            if(iend - ip < 2) {
+                return false;
+            }
+            uint32_t offset = ip[0] | (ip[1] << 8);
+            ip += 2;
+            uint32_t len = token & 0x0F;
+            if(len == 15 && !readLength(ip, iend, len)) {
+                return false;
+            }
+            len += MIN_MATCH;
+            if(offset == 0 || offset > (uint32_t)(op - out) || len > (uint32_t)(oend - op)) {
+                return false;
+            }
+            const uint8_t* ref = op - offset;
+            if(offset >= len) {
+                memcpy(op, ref, len);
+                op += len;
+            } else {
+                // overlapping, the match repeats its own output
+                for(uint32_t i = 0; i < len; ++i) {
+                    *op++ = *ref++;
+                }
+            }
+        }
+        return op == oend;
+    }
+
+private:
+    enum
+    {
+        HASH_BITS     = 12,
+        HASH_SIZE     = 1 << HASH_BITS,
+        MIN_MATCH     = 4,
+        LAST_LITERALS = 5,
+        MIN_TAIL      = 12
+    };
+    static uint32_t read32(const uint8_t* ptr)
+    {
+        uint32_t v;
+        memcpy(&v, ptr, sizeof(v));
+        return v;
+    }
+    static uint32_t hash(uint32_t seq)
+    {
+        return (seq * 2654435761U) >> (32 - HASH_BITS);
+    }
+    static uint8_t* writeLength(uint8_t* op, uint32_t len)
+    {
+        for(; len >= 255; len -= 255) {
+            *op++ = 255;
+        }
+        *op++ = (uint8_t)len;
+        return op;
+    }
+    static bool readLength(const uint8_t*& ip, const uint8_t* iend, uint32_t& len)
+    {
+        uint8_t b;
+        do {
+            if(ip == iend) {
+                return false;
+            }
+            b = *ip++;
+            len += b;
+        } while(b == 255);
+        return true;
+    }
+    static uint8_t* writeSequence(uint8_t* op, const uint8_t* lit, uint32_t litLen,
+                                  uint32_t offset, uint32_t len)
+    {
+        len -= MIN_MATCH;
+        uint8_t* token = op++;
+        *token = (uint8_t)(((litLen < 15 ? litLen : 15) << 4) | (len < 15 ? len : 15));
+        if(litLen >= 15) {
+            op = writeLength(op, litLen - 15);
+        }
+        memcpy(op, lit, litLen);
+        op += litLen;
+        *op++ = (uint8_t)offset;
+        *op++ = (uint8_t)(offset >> 8);
+        if(len >= 15) {
+            op = writeLength(op, len - 15);
+        }
+        return op;
+    }
+    static uint8_t* writeLiterals(uint8_t* op, const uint8_t* lit, uint32_t litLen)
+    {
+        *op++ = (uint8_t)((litLen < 15 ? litLen : 15) << 4);
+        if(litLen >= 15) {
+            op = writeLength(op, litLen - 15);
+        }
+        memcpy(op, lit, litLen);
+        return op + litLen;
+    }
+};
+
+} // namespace ygg
+
+#endif //YGG_LZ_HPP
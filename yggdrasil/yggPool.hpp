@@ -0,0 +1,124 @@
+#ifndef YGG_POOL_HPP
+#define YGG_POOL_HPP
+
+#include <stdint.h>
+#include <cstddef>
+
+namespace ygg
+{
+
+// Store of the objects of one type, the objects deleted go back
+// to it instead of the heap.
+class ObjectPoolBase
+{
+public:
+    struct Statistics
+    {
+        Statistics()
+         : capacity(0),
+           available(0),
+           hits(0),
+           misses(0)
+        {}
+        uint32_t capacity;
+        uint32_t available;
+        // allocations served by the pool and the ones that went
+        // to the heap because it was empty
+        uint32_t hits;
+        uint32_t misses;
+    };
+public:
+    virtual ~ObjectPoolBase()
+    {}
+    // NULL if the pool can't serve it, the caller goes to the heap
+    virtual void* allocate(size_t size) = 0;
+    // false if ptr doesn't come from the pool
+    virtual bool release(void* ptr) = 0;
+    virtual Statistics statistics() = 0;
+protected:
+    // the slots keep the alignment of the heap
+    static uint32_t slotSize(uint32_t objectSize)
+    {
+        union Align
+        {
+            uint64_t u;
+            double   d;
+            void*    p;
+        };
+        uint32_t size = objectSize < sizeof(void*) ? sizeof(void*) : objectSize;
+        return (size + sizeof(Align) - 1) / sizeof(Align) * sizeof(Align);
+    }
+};
+
+// Fixed number of slots taken from the heap once, the free ones
+// are chained through their first bytes.
+template <class MutexType>
+class ObjectPool : public ObjectPoolBase
+{
+public:
+    ObjectPool(uint32_t objectSize, uint32_t capacity)
+     : mObjectSize(objectSize),
+       mSlotSize(slotSize(objectSize)),
+       mBegin(new uint8_t[mSlotSize * capacity]),
+       mEnd(mBegin + mSlotSize * capacity),
+       mFree(NULL)
+    {
+        mStats.capacity = capacity;
+        mStats.available = capacity;
+        for(uint8_t* slot = mEnd; slot != mBegin; ) {
+            slot -= mSlotSize;
+            *(void**)slot = mFree;
+            mFree = slot;
+        }
+    }
+    ~ObjectPool()
+    {
+        delete[] mBegin;
+    }
+    void* allocate(size_t size)
+    {
+        void* ptr = NULL;
+        mMutex.lock();
+        if(mFree && size <= mObjectSize) {
+            ptr = mFree;
+            mFree = *(void**)ptr;
+            --mStats.available;
+            ++mStats.hits;
+        } else {
+            ++mStats.misses;
+        }
+        mMutex.unlock();
+        return ptr;
+    }
+    bool release(void* ptr)
+    {
+        if((uint8_t*)ptr < mBegin || (uint8_t*)ptr >= mEnd) {
+            return false;
+        }
+        mMutex.lock();
+        *(void**)ptr = mFree;
+        mFree = ptr;
+        ++mStats.available;
+        mMutex.unlock();
+        return true;
+    }
+    Statistics statistics()
+    {
+        mMutex.lock();
+        Statistics stats = mStats;
+        mMutex.unlock();
+        return stats;
+    }
+private:
+    uint32_t   mObjectSize;
+    uint32_t   mSlotSize;
+    uint8_t*   mBegin;
+    uint8_t*   mEnd;
+    void*      mFree;
+    Statistics mStats;
+    MutexType  mMutex;
+};
+
+} // namespace ygg
+
+#endif //YGG_POOL_HPP
@@ -1,13 +1,17 @@
 #ifndef YGG_POSIX_TRAITS_HPP
 #define YGG_POSIX_TRAITS_HPP
 
+#include "yggBaseTypes.hpp"
+#include "yggPool.hpp"
 #include <stdint.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/uio.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <errno.h>
 #include <string.h>
+#include <algorithm>
 #include <sys/time.h>
 #include <cassert>
 
@@ -54,6 +58,30 @@ public:
     {
         pthread_cond_wait(&mCond, &mCondMutex);
     }
+    // false once ms passed without a signal
+    bool wait(uint32_t ms)
+    {
+        return waitUntil(deadline(ms));
+    }
+    // the end of a wait that may be woken up several times
+    typedef struct timespec Deadline;
+    static Deadline deadline(uint32_t ms)
+    {
+        struct timespec time;
+        clock_gettime(CLOCK_REALTIME, &time);
+        time.tv_sec += ms / 1000;
+        time.tv_nsec += (ms % 1000) * 1000000;
+        if(time.tv_nsec >= 1000000000) {
+            ++time.tv_sec;
+            time.tv_nsec -= 1000000000;
+        }
+        return time;
+    }
+    // false once the deadline passed without a signal
+    bool waitUntil(const Deadline& time)
+    {
+        return pthread_cond_timedwait(&mCond, &mCondMutex, &time) != ETIMEDOUT;
+    }
     void signal() 
     {
         pthread_cond_signal(&mCond);
@@ -163,14 +191,59 @@ public:
         // return false if error on the device
         return true;
     }
+    uint32_t readSome(void* b, uint32_t size)
+    {
+        ssize_t bytes_read;
+        do {
+            bytes_read = ::read(mDesc, b, size);
+        } while(bytes_read < 0 && errno == EINTR);
+        // return 0 if error on the device or end of file
+        return bytes_read > 0 ? (uint32_t)bytes_read : 0;
+    }
     bool write(const void* b, uint32_t size) 
     {
-        uint32_t bytes_write = 0;
-        while(size-bytes_write) {
-            bytes_write += ::write(mDesc, (uint8_t*)b + bytes_write, size-bytes_write);
+        IoChunk chunk = { b, size };
+        return write(&chunk, 1);
+    }
+    bool write(const IoChunk* chunks, uint32_t count)
+    {
+        struct iovec iov[IOV_COUNT];
+        // bytes of the first chunk already written
+        uint32_t done = 0;
+        while(true) {
+            while(count && chunks[0].size == done) {
+                ++chunks;
+                --count;
+                done = 0;
+            }
+            if(count == 0) {
+                return true;
+            }
+            uint32_t n = std::min<uint32_t>(count, IOV_COUNT);
+            for(uint32_t i = 0; i < n; ++i) {
+                iov[i].iov_base = (uint8_t*)chunks[i].ptr;
+                iov[i].iov_len = chunks[i].size;
+            }
+            iov[0].iov_base = (uint8_t*)chunks[0].ptr + done;
+            iov[0].iov_len -= done;
+            ssize_t bytes_write = ::writev(mDesc, iov, n);
+            if(bytes_write < 0 && errno == EINTR) {
+                continue;
+            }
+            if(bytes_write <= 0) {
+                // error on the device
+                return false;
+            }
+            // a short write, go on from where it stopped
+            size_t left = bytes_write;
+            while(left && left >= chunks[0].size - done) {
+                left -= chunks[0].size - done;
+                ++chunks;
+                --count;
+                done = 0;
+            }
+            done += left;
         }
-        // return false if error on the device
-        return true;
     }
     bool isOpen() 
     {
@@ -179,6 +252,11 @@ public:
     }
 
 private:
+    enum
+    {
+        // chunks passed to a single writev
+        IOV_COUNT = 16
+    };
     int mDesc;
 };
 
@@ -193,6 +271,16 @@ public:
         clock_gettime(CLOCK_MONOTONIC, &sTime);
         return (uint32_t) ((sTime.tv_sec * KILO) + (sTime.tv_nsec / MEGA));
     }
+    // nothing to set up, the monotonic clock runs from boot
+    static void start()
+    {}
+    // monotonic, doesn't wrap
+    static uint64_t getMicroseconds()
+    {
+        struct timespec time;
+        clock_gettime(CLOCK_MONOTONIC, &time);
+        return (uint64_t)time.tv_sec * 1000000 + time.tv_nsec / 1000;
+    }
 };
 
 
@@ -204,6 +292,7 @@ public:
     typedef PosixThread  ThreadType;
     typedef PosixDevice  DeviceType;
     typedef PosixUtils   Utils;
+    typedef ObjectPool<PosixMutex> PoolType;
 };
 
 } // namespace ygg
@@ -1,12 +1,17 @@
 #ifndef YGG_QT_TRAITS_HPP
 #define YGG_QT_TRAITS_HPP
 
+#include "yggBaseTypes.hpp"
+#include "yggPool.hpp"
 #include <QMutex>
 #include <QWaitCondition>
 #include <QThread>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QFile>
 #include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
 #include <sys/time.h>
 
 namespace ygg
@@ -23,6 +28,33 @@ public:
     {
         QWaitCondition::wait(&mCondMutex);
     }
+    // false once ms passed without a signal
+    bool wait(uint32_t ms)
+    {
+        return QWaitCondition::wait(&mCondMutex, ms);
+    }
+    // the end of a wait that may be woken up several times
+    struct Deadline
+    {
+        QElapsedTimer start;
+        qint64        ms;
+    };
+    static Deadline deadline(uint32_t ms)
+    {
+        Deadline d;
+        d.start.start();
+        d.ms = ms;
+        return d;
+    }
+    // false once the deadline passed without a signal
+    bool waitUntil(const Deadline& d)
+    {
+        qint64 elapsed = d.start.elapsed();
+        if(elapsed >= d.ms) {
+            return false;
+        }
+        return QWaitCondition::wait(&mCondMutex, d.ms - elapsed);
+    }
     void signal() 
     {
         wakeAll();
@@ -106,10 +138,29 @@ public:
     {
         return QFile::readData((char*)b, size) == size;
     }
+    uint32_t readSome(void* b, uint32_t size)
+    {
+        // QFile::readData keeps reading until it gets 'size' bytes,
+        // go to the descriptor to get only what is available
+        ssize_t bytes_read;
+        do {
+            bytes_read = ::read(handle(), b, size);
+        } while(bytes_read < 0 && errno == EINTR);
+        return bytes_read > 0 ? (uint32_t)bytes_read : 0;
+    }
     bool write(const void* b, uint32_t size) 
     {
         return QFile::writeData((const char*)b, size) == size;
     }
+    bool write(const IoChunk* chunks, uint32_t count)
+    {
+        for(uint32_t i = 0; i < count; ++i) {
+            if(!write(chunks[i].ptr, chunks[i].size)) {
+                return false;
+            }
+        }
+        return true;
+    }
     bool isOpen() 
     {
         return QFile::isOpen();
@@ -124,6 +175,27 @@ public:
     {
         return (uint32_t) QDateTime::currentMSecsSinceEpoch();
     }
+    // starts the clock once, before any thread reads it
+    static void start()
+    {
+        if(!timer().isValid()) {
+            timer().start();
+        }
+    }
+    // monotonic, doesn't wrap, 0 until start()
+    static uint64_t getMicroseconds()
+    {
+        if(!timer().isValid()) {
+            return 0;
+        }
+        return timer().nsecsElapsed() / 1000;
+    }
+private:
+    static QElapsedTimer& timer()
+    {
+        static QElapsedTimer sTimer;
+        return sTimer;
+    }
 };
 
 class QtSystemTraits
@@ -134,6 +206,7 @@ public:
     typedef QtThread  ThreadType;
     typedef QtDevice  DeviceType;
     typedef QtUtils   Utils;
+    typedef ObjectPool<QMutex> PoolType;
 };
 
 } // namespace ygg
@@ -1,79 +1,168 @@
 #ifndef YGG_DATA_QUEUE_HPP
 #define YGG_DATA_QUEUE_HPP
 
+#include "yggConfig.hpp"
+#include "yggBaseTypes.hpp"
+#include <stdint.h>
 #include <cstddef>
 #include <list>
 
-namespace ygg 
+namespace ygg
 {
 
+// The queue owns the objects pushed, the ones the overflow policy
+// throws away are deleted and counted.
 template <class Type, class MutexType, class CondType>
 class Queue
 {
 public:
     typedef std::list<Type*> TypeList;
 public:
-    Queue(uint32_t maxSize);
+    Queue(uint32_t maxSize, ConfigOverflow policy = OVERFLOW_DROP_NEWEST,
+          uint32_t blockMs = 0);
     Type* pop();
+    // false if an object was dropped to make it fit, or dt itself
     bool push(Type* dt);
     void popAll(TypeList& dlist);
+    // appends what is queued without waiting, false if nothing was
+    bool takeAll(TypeList& dlist);
     void clear();
+    // objects thrown away and the most that were ever queued
+    uint32_t drops() const;
+    uint32_t highWater() const;
 private:
-    MutexType mMutex;
+    void taken();
+    void dropFront();
+private:
+    mutable MutexType mMutex;
     CondType  mCond;
+    // signalled when there is room again, OVERFLOW_BLOCK only
+    CondType  mSpace;
     TypeList  mQueue;
     uint32_t  mMaxSize;
+    uint32_t  mSize;
+    ConfigOverflow mPolicy;
+    uint32_t  mBlockMs;
+    uint32_t  mDrops;
+    uint32_t  mHighWater;
 };
 
 template <class T, class M, class C>
-Queue<T,M,C>::Queue(uint32_t maxSize)
+Queue<T,M,C>::Queue(uint32_t maxSize, ConfigOverflow policy, uint32_t blockMs)
  : mCond(mMutex),
-   mMaxSize(maxSize)
+   mSpace(mMutex),
+   mMaxSize(maxSize),
+   mSize(0),
+   mPolicy(policy),
+   mBlockMs(blockMs),
+   mDrops(0),
+   mHighWater(0)
 { }
 
 template <class T, class M, class C>
-T* 
+T*
 Queue<T,M,C>::pop()
 {
     mMutex.lock();
     while(mQueue.empty()) {
         mCond.wait();
-    } 
+    }
     T* dt = mQueue.front();
-    mQueue.pop_front();  
+    mQueue.pop_front();
+    --mSize;
+    taken();
     mMutex.unlock();
     return dt;
 }
 
 template <class T, class M, class C>
-bool 
+bool
 Queue<T,M,C>::push(T* dt)
 {
-    bool ok = false;
+    bool ok = true;
     mMutex.lock();
-    if(mQueue.size() < mMaxSize) {
+    if(mPolicy == OVERFLOW_LATEST) {
+        // an object of the same type still waiting is replaced
+        typename TypeList::iterator dit = mQueue.begin();
+        typename TypeList::iterator edit = mQueue.end();
+        for(; dit != edit; ++dit) {
+            if((*dit)->id() == dt->id()) {
+                delete *dit;
+                *dit = dt;
+                ++mDrops;
+                mMutex.unlock();
+                return false;
+            }
+        }
+    }
+    if(mSize >= mMaxSize) {
+        switch(mPolicy) {
+        case OVERFLOW_BLOCK: {
+            // wakeups with no room left wait for what is left of mBlockMs
+            typename C::Deadline deadline = C::deadline(mBlockMs);
+            while(mSize >= mMaxSize && mSpace.waitUntil(deadline))
+            {}
+            break;
+        }
+        case OVERFLOW_DROP_OLDEST:
+            dropFront();
+            ok = false;
+            break;
+        default:
+            break;
+        }
+    }
+    if(mSize < mMaxSize) {
         mQueue.push_back(dt);
+        ++mSize;
+        if(mSize > mHighWater) {
+            mHighWater = mSize;
+        }
+        if(mSize < mMaxSize) {
+            // pass the room left on to the next one waiting
+            taken();
+        }
         mCond.signal();
-        ok = true;
+    } else {
+        delete dt;
+        ++mDrops;
+        ok = false;
     }
     mMutex.unlock();
     return ok;
 }
 
 template <class T, class M, class C>
-void 
-Queue<T,M,C>::popAll(TypeList& dlist) 
+void
+Queue<T,M,C>::popAll(TypeList& dlist)
 {
     mMutex.lock();
     while(mQueue.empty()) {
         mCond.wait();
-    } 
+    }
     dlist.swap(mQueue);
+    mSize = 0;
+    taken();
     mMutex.unlock();
 }
 
 template <class T, class M, class C>
-void 
+bool
+Queue<T,M,C>::takeAll(TypeList& dlist)
+{
+    mMutex.lock();
+    bool any = !mQueue.empty();
+    if(any) {
+        dlist.splice(dlist.end(), mQueue);
+        mSize = 0;
+        taken();
+    }
+    mMutex.unlock();
+    return any;
+}
+
+template <class T, class M, class C>
+void
 Queue<T,M,C>::clear()
 {
     mMutex.lock();
@@ -83,10 +172,620 @@ Queue<T,M,C>::clear()
         delete *dit;
     }
     mQueue.clear();
+    mSize = 0;
+    taken();
+    mMutex.unlock();
+}
+
+template <class T, class M, class C>
+uint32_t
+Queue<T,M,C>::drops() const
+{
+    mMutex.lock();
+    uint32_t drops = mDrops;
     mMutex.unlock();
-}   
+    return drops;
+}
+
+template <class T, class M, class C>
+uint32_t
+Queue<T,M,C>::highWater() const
+{
+    mMutex.lock();
+    uint32_t highWater = mHighWater;
+    mMutex.unlock();
+    return highWater;
+}
+
+// called with the mutex held once there is room
+template <class T, class M, class C>
+void
+Queue<T,M,C>::taken()
+{
+    if(mPolicy == OVERFLOW_BLOCK) {
+        mSpace.signal();
+    }
+}
+
+template <class T, class M, class C>
+void
+Queue<T,M,C>::dropFront()
+{
+    delete mQueue.front();
+    mQueue.pop_front();
+    --mSize;
+    ++mDrops;
+}
+
+// Bounded ring for exactly one pushing and one popping thread. The
+// indices are published with full barriers (GCC __sync builtins), 
+// the mutex and the condition variables are only taken when one 
+// side has to sleep. clear() belongs to the popping thread too.
+// Overflow: OVERFLOW_BLOCK waits for room, every other policy drops
+// the object pushed, the ring can't touch the objects queued. The 
+// indices count on past 2^32, the slots are a power of two so that 
+// they keep their place when the counters wrap.
+template <class Type, class MutexType, class CondType>
+class RingQueue
+{
+public:
+    typedef std::list<Type*> TypeList;
+public:
+    RingQueue(uint32_t maxSize, ConfigOverflow policy = OVERFLOW_DROP_NEWEST,
+              uint32_t blockMs = 0);
+    ~RingQueue();
+    Type* pop();
+    bool push(Type* dt);
+    void popAll(TypeList& dlist);
+    bool takeAll(TypeList& dlist);
+    void clear();
+    uint32_t drops() const;
+    uint32_t highWater() const;
+private:
+    enum
+    {
+        CACHE_LINE = 64
+    };
+    static void fence()
+    {
+        __sync_synchronize();
+    }
+    // maxSize rounded up to a power of two
+    static uint32_t slotCount(uint32_t maxSize);
+    void waitForData();
+    void waitForRoom();
+    Type* take();
+private:
+    Type**    mSlots;
+    // the slot of an index, slotCount() - 1
+    uint32_t  mSlotMask;
+    uint32_t  mMaxSize;
+    ConfigOverflow mPolicy;
+    uint32_t  mBlockMs;
+    MutexType mMutex;
+    CondType  mCond;
+    CondType  mSpace;
+    // the popping side
+    uint8_t   mPad0[CACHE_LINE];
+    volatile uint32_t mHead;
+    volatile bool     mConsumerWaiting;
+    // the pushing side, the counters are written only there
+    uint8_t   mPad1[CACHE_LINE];
+    volatile uint32_t mTail;
+    volatile bool     mProducerWaiting;
+    volatile uint32_t mDrops;
+    volatile uint32_t mHighWater;
+    uint8_t   mPad2[CACHE_LINE];
+};
+
+// Intrusive queue for any number of pushing threads and one popping
+// thread, after D. Vyukov: the objects are chained through their
+// QueueLink, a push is one exchange on the tail. The size is kept 
+// in a counter reserved before the object is linked. The pushing 
+// side takes the mutex only when the popping side sleeps or the 
+// queue is full under OVERFLOW_BLOCK, every other policy drops the 
+// object pushed. clear() may come from another thread, the two
+// popping calls are serialized with a mutex of their own.
+template <class Type, class MutexType, class CondType>
+class MpscQueue
+{
+public:
+    typedef std::list<Type*> TypeList;
+public:
+    MpscQueue(uint32_t maxSize, ConfigOverflow policy = OVERFLOW_DROP_NEWEST,
+              uint32_t blockMs = 0);
+    Type* pop();
+    bool push(Type* dt);
+    void popAll(TypeList& dlist);
+    bool takeAll(TypeList& dlist);
+    void clear();
+    uint32_t drops() const;
+    uint32_t highWater() const;
+private:
+    enum
+    {
+        CACHE_LINE = 64
+    };
+    static void fence()
+    {
+        __sync_synchronize();
+    }
+    static uint32_t add(volatile uint32_t* v, int32_t d)
+    {
+        return __sync_add_and_fetch(v, d);
+    }
+    bool reserve();
+    void raiseHighWater(uint32_t used);
+    void link(QueueLink* l);
+    // the next object, NULL if there is none or a push 
+    // is half way through
+    Type* unlink();
+    // done with count objects taken out of the queue
+    void released(uint32_t count);
+    void waitForData();
+private:
+    uint32_t  mMaxSize;
+    ConfigOverflow mPolicy;
+    uint32_t  mBlockMs;
+    MutexType mMutex;
+    CondType  mCond;
+    CondType  mSpace;
+    MutexType mPopMutex;
+    uint8_t   mPad0[CACHE_LINE];
+    // the pushing side
+    QueueLink* volatile mTail;
+    volatile uint32_t   mCount;
+    volatile uint32_t   mProducersWaiting;
+    volatile uint32_t   mDrops;
+    volatile uint32_t   mHighWater;
+    uint8_t   mPad1[CACHE_LINE];
+    // the popping side
+    QueueLink*          mHead;
+    volatile bool       mConsumerWaiting;
+    QueueLink           mStub;
+    uint8_t   mPad2[CACHE_LINE];
+};
+
+// the queue a ConfigQueue selects
+template <class Type, class MutexType, class CondType, ConfigQueue Q>
+struct QueueOf
+{
+    typedef Queue<Type,MutexType,CondType> QueueType;
+};
+
+template <class Type, class MutexType, class CondType>
+struct QueueOf<Type,MutexType,CondType,QUEUE_RING>
+{
+    typedef RingQueue<Type,MutexType,CondType> QueueType;
+};
+
+template <class Type, class MutexType, class CondType>
+struct QueueOf<Type,MutexType,CondType,QUEUE_MPSC>
+{
+    typedef MpscQueue<Type,MutexType,CondType> QueueType;
+};
+
+// the queue a ConfigQueue selects for the output of a serializer, 
+// every sending thread pushes to it and the reader resets it: 
+// the single producer ring is left undefined, it doesn't compile
+template <class Type, class MutexType, class CondType, ConfigQueue Q>
+struct OutputQueueOf : QueueOf<Type,MutexType,CondType,Q>
+{};
+
+template <class Type, class MutexType, class CondType>
+struct OutputQueueOf<Type,MutexType,CondType,QUEUE_RING>;
+
+template <class T, class M, class C>
+RingQueue<T,M,C>::RingQueue(uint32_t maxSize, ConfigOverflow policy, uint32_t blockMs)
+ : mSlots(new T*[slotCount(maxSize)]),
+   mSlotMask(slotCount(maxSize) - 1),
+   mMaxSize(maxSize),
+   mPolicy(policy),
+   mBlockMs(blockMs),
+   mCond(mMutex),
+   mSpace(mMutex),
+   mHead(0),
+   mConsumerWaiting(false),
+   mTail(0),
+   mProducerWaiting(false),
+   mDrops(0),
+   mHighWater(0)
+{ }
+
+template <class T, class M, class C>
+RingQueue<T,M,C>::~RingQueue()
+{
+    delete[] mSlots;
+}
+
+template <class T, class M, class C>
+T*
+RingQueue<T,M,C>::pop()
+{
+    if(mTail == mHead) {
+        waitForData();
+    }
+    return take();
+}
+
+template <class T, class M, class C>
+bool
+RingQueue<T,M,C>::push(T* dt)
+{
+    uint32_t tail = mTail;
+    if(tail - mHead >= mMaxSize && mPolicy == OVERFLOW_BLOCK) {
+        waitForRoom();
+    }
+    if(tail - mHead >= mMaxSize) {
+        delete dt;
+        ++mDrops;
+        return false;
+    }
+    mSlots[tail & mSlotMask] = dt;
+    // the slot is written before the index shows it
+    fence();
+    mTail = tail + 1;
+    uint32_t used = tail + 1 - mHead;
+    if(used > mHighWater) {
+        mHighWater = used;
+    }
+    // the index is out before the flag is read, a popping side 
+    // going to sleep either sees it or is woken up
+    fence();
+    if(mConsumerWaiting) {
+        mMutex.lock();
+        mCond.signal();
+        mMutex.unlock();
+    }
+    return true;
+}
+
+template <class T, class M, class C>
+void
+RingQueue<T,M,C>::popAll(TypeList& dlist)
+{
+    if(mTail == mHead) {
+        waitForData();
+    }
+    while(mTail != mHead) {
+        dlist.push_back(take());
+    }
+}
+
+template <class T, class M, class C>
+bool
+RingQueue<T,M,C>::takeAll(TypeList& dlist)
+{
+    bool any = mTail != mHead;
+    while(mTail != mHead) {
+        dlist.push_back(take());
+    }
+    return any;
+}
+
+template <class T, class M, class C>
+void
+RingQueue<T,M,C>::clear()
+{
+    while(mTail != mHead) {
+        delete take();
+    }
+}
+
+template <class T, class M, class C>
+uint32_t
+RingQueue<T,M,C>::drops() const
+{
+    return mDrops;
+}
+
+template <class T, class M, class C>
+uint32_t
+RingQueue<T,M,C>::highWater() const
+{
+    return mHighWater;
+}
+
+template <class T, class M, class C>
+uint32_t
+RingQueue<T,M,C>::slotCount(uint32_t maxSize)
+{
+    uint32_t count = 1;
+    while(count < maxSize) {
+        count <<= 1;
+    }
+    return count;
+}
+
+template <class T, class M, class C>
+void
+RingQueue<T,M,C>::waitForData()
+{
+    mMutex.lock();
+    mConsumerWaiting = true;
+    fence();
+    while(mTail == mHead) {
+        mCond.wait();
+    }
+    mConsumerWaiting = false;
+    mMutex.unlock();
+}
+
+template <class T, class M, class C>
+void
+RingQueue<T,M,C>::waitForRoom()
+{
+    mMutex.lock();
+    mProducerWaiting = true;
+    fence();
+    typename C::Deadline deadline = C::deadline(mBlockMs);
+    while(mTail - mHead >= mMaxSize && mSpace.waitUntil(deadline))
+    {}
+    mProducerWaiting = false;
+    mMutex.unlock();
+}
+
+// the popping side, there is an object
+template <class T, class M, class C>
+T*
+RingQueue<T,M,C>::take()
+{
+    uint32_t head = mHead;
+    // the slot is read after the index showing it
+    fence();
+    T* dt = mSlots[head & mSlotMask];
+    fence();
+    mHead = head + 1;
+    if(mPolicy == OVERFLOW_BLOCK) {
+        fence();
+        if(mProducerWaiting) {
+            mMutex.lock();
+            mSpace.signal();
+            mMutex.unlock();
+        }
+    }
+    return dt;
+}
+
+template <class T, class M, class C>
+MpscQueue<T,M,C>::MpscQueue(uint32_t maxSize, ConfigOverflow policy, uint32_t blockMs)
+ : mMaxSize(maxSize),
+   mPolicy(policy),
+   mBlockMs(blockMs),
+   mCond(mMutex),
+   mSpace(mMutex),
+   mTail(&mStub),
+   mCount(0),
+   mProducersWaiting(0),
+   mDrops(0),
+   mHighWater(0),
+   mHead(&mStub),
+   mConsumerWaiting(false)
+{ }
+
+template <class T, class M, class C>
+T*
+MpscQueue<T,M,C>::pop()
+{
+    T* dt = NULL;
+    while(dt == NULL) {
+        waitForData();
+        mPopMutex.lock();
+        dt = unlink();
+        mPopMutex.unlock();
+    }
+    released(1);
+    return dt;
+}
+
+template <class T, class M, class C>
+bool
+MpscQueue<T,M,C>::push(T* dt)
+{
+    if(!reserve()) {
+        delete dt;
+        add(&mDrops, 1);
+        return false;
+    }
+    link(dt);
+    // the exchange in link() is a full barrier, a popping side 
+    // going to sleep either sees the object or is woken up
+    if(mConsumerWaiting) {
+        mMutex.lock();
+        mCond.signal();
+        mMutex.unlock();
+    }
+    return true;
+}
+
+template <class T, class M, class C>
+void
+MpscQueue<T,M,C>::popAll(TypeList& dlist)
+{
+    while(dlist.empty()) {
+        waitForData();
+        mPopMutex.lock();
+        for(T* dt = unlink(); dt != NULL; dt = unlink()) {
+            dlist.push_back(dt);
+        }
+        mPopMutex.unlock();
+    }
+    released(dlist.size());
+}
+
+template <class T, class M, class C>
+bool
+MpscQueue<T,M,C>::takeAll(TypeList& dlist)
+{
+    uint32_t count = 0;
+    mPopMutex.lock();
+    for(T* dt = unlink(); dt != NULL; dt = unlink()) {
+        dlist.push_back(dt);
+        ++count;
+    }
+    mPopMutex.unlock();
+    released(count);
+    return count != 0;
+}
+
+template <class T, class M, class C>
+void
+MpscQueue<T,M,C>::clear()
+{
+    uint32_t count = 0;
+    mPopMutex.lock();
+    for(T* dt = unlink(); dt != NULL; dt = unlink()) {
+        delete dt;
+        ++count;
+    }
+    mPopMutex.unlock();
+    released(count);
+}
+
+template <class T, class M, class C>
+uint32_t
+MpscQueue<T,M,C>::drops() const
+{
+    return mDrops;
+}
+
+template <class T, class M, class C>
+uint32_t
+MpscQueue<T,M,C>::highWater() const
+{
+    return mHighWater;
+}
+
+template <class T, class M, class C>
+bool
+MpscQueue<T,M,C>::reserve()
+{
+    uint32_t used = add(&mCount, 1);
+    if(used <= mMaxSize) {
+        raiseHighWater(used);
+        return true;
+    }
+    add(&mCount, -1);
+    if(mPolicy != OVERFLOW_BLOCK) {
+        return false;
+    }
+    bool ok = false;
+    mMutex.lock();
+    add(&mProducersWaiting, 1);
+    typename C::Deadline deadline = C::deadline(mBlockMs);
+    while(true) {
+        used = add(&mCount, 1);
+        if(used <= mMaxSize) {
+            ok = true;
+            break;
+        }
+        add(&mCount, -1);
+        if(!mSpace.waitUntil(deadline)) {
+            break;
+        }
+    }
+    add(&mProducersWaiting, -1);
+    if(ok && used < mMaxSize) {
+        // pass the room left on to the next one waiting
+        mSpace.signal();
+    }
+    mMutex.unlock();
+    if(ok) {
+        raiseHighWater(used);
+    }
+    return ok;
+}
+
+template <class T, class M, class C>
+void
+MpscQueue<T,M,C>::raiseHighWater(uint32_t used)
+{
+    uint32_t high = mHighWater;
+    while(used > high) {
+        uint32_t seen = __sync_val_compare_and_swap(&mHighWater, high, used);
+        if(seen == high) {
+            break;
+        }
+        high = seen;
+    }
+}
+
+template <class T, class M, class C>
+void
+MpscQueue<T,M,C>::link(QueueLink* l)
+{
+    l->mNext = NULL;
+    // the exchange alone only acquires, the fences around it make 
+    // it a full barrier both ways
+    fence();
+    QueueLink* prev = __sync_lock_test_and_set(&mTail, l);
+    fence();
+    // until here the popping side sees the chain end at prev
+    prev->mNext = l;
+}
+
+template <class T, class M, class C>
+T*
+MpscQueue<T,M,C>::unlink()
+{
+    QueueLink* head = mHead;
+    fence();
+    QueueLink* next = head->mNext;
+    if(head == &mStub) {
+        if(next == NULL) {
+            return NULL;
+        }
+        mHead = next;
+        head = next;
+        fence();
+        next = next->mNext;
+    }
+    if(next == NULL) {
+        if(head != mTail) {
+            // a push is between the exchange and the link
+            return NULL;
+        }
+        // the last one, the stub goes behind it to take its place
+        link(&mStub);
+        fence();
+        next = head->mNext;
+        if(next == NULL) {
+            return NULL;
+        }
+    }
+    mHead = next;
+    return static_cast<T*>(head);
+}
+
+template <class T, class M, class C>
+void
+MpscQueue<T,M,C>::released(uint32_t count)
+{
+    add(&mCount, -(int32_t)count);
+    if(count && mProducersWaiting) {
+        mMutex.lock();
+        mSpace.signal();
+        mMutex.unlock();
+    }
+}
+
+template <class T, class M, class C>
+void
+MpscQueue<T,M,C>::waitForData()
+{
+    if(mCount != 0) {
+        return;
+    }
+    mMutex.lock();
+    mConsumerWaiting = true;
+    fence();
+    while(mCount == 0) {
+        mCond.wait();
+    }
+    mConsumerWaiting = false;
+    mMutex.unlock();
+}
 
 } //namespace ygg
 
 #endif //YGG_DATA_QUEUE_HPP
-
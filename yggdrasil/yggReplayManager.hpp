@@ -5,6 +5,7 @@
 #include "yggTransportImpl.hpp"
 #include "yggSerializer.hpp"
 #include "yggDeserializer.hpp"
+#include "yggLogDevice.hpp"
 #include <cstddef>
 
 namespace ygg 
@@ -24,7 +25,9 @@ public:
     typedef typename S::DeviceType Device;
     typedef typename S::Utils      Utils;
     typedef ygg::DummySerializer   Serializer;
-    typedef ConfiguredTransport<C,Device>      Transport;
+    // the log file device is wrapped to read C::LogFormat
+    typedef ygg::LogDevice<Device,C::LogFormat> LogDevice;
+    typedef ConfiguredTransport<C,LogDevice>   Transport;
     typedef ConfiguredTransport<C,DummyDevice> Logger;
     typedef typename Device::Params            DeviceParams;
     typedef ygg::Deserializer<S,Serializer,I,Logger,C> Deserializer;
@@ -65,6 +68,14 @@ void
 ReplayManager<S,I,T,C>::startReplay(Transport& transport, I& handler, T& terminator)
 {
     TypeRegistry::initialize();
+    // the objects of the registered types come from their pools
+    if(C::Allocation == ALLOCATION_POOLED) {
+        TypeRegistry::createPools<typename S::PoolType>(C::ObjectPoolSize);
+    }
+    // the received objects are stamped with their arrival time, 
+    // the clock starts before the threads that read it
+    Utils::start();
+    transport.setClock(&Utils::getMicroseconds);
     // start the transport
     transport.start();
     if(transport.isError()) {
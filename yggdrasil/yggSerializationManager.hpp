@@ -5,6 +5,7 @@
 #include "yggTransportImpl.hpp"
 #include "yggSerializer.hpp"
 #include "yggDeserializer.hpp"
+#include "yggLogDevice.hpp"
 #include <cstddef>
 
 namespace ygg 
@@ -24,9 +25,12 @@ public:
     typedef typename S::Utils      Utils;
     typedef ygg::Serializer<S,C>   Serializer;
     typedef ConfiguredTransport<C,Device> Transport;
-    typedef ConfiguredTransport<C,L>      Logger;
+    // the log file device is wrapped to write C::LogFormat
+    typedef ygg::LogDevice<L,C::LogFormat> LogDevice;
+    typedef ConfiguredTransport<C,LogDevice> Logger;
     typedef typename Device::Params       DeviceParams;
     typedef ygg::Deserializer<S,Serializer,I,Logger,C> Deserializer;
+    typedef ygg::Transport::LinkStatistics LinkStatistics;
 
 public:
     // API used for the service initialization/start/stop.
@@ -34,9 +38,12 @@ public:
     static void stopService();
     // API usef for logging
     static void startLogger(Logger& logger);
+    // the log device can be flushed once it returns
     static void stopLogger();
     // API for sending serializable objects.
     static void send(TypeBase* d);
+    // API for watching the link, all zero while the service is stopped
+    static LinkStatistics statistics();
 
 private:
     template <typename TM, ConfigManifest> class ManifestRequester;
@@ -68,8 +75,16 @@ void
 SerializationManager<S,I,C,L>::startService(Transport& transport, I& handler)
 {
     TypeRegistry::initialize();
+    // the objects of the registered types come from their pools
+    if(C::Allocation == ALLOCATION_POOLED) {
+        TypeRegistry::createPools<typename S::PoolType>(C::ObjectPoolSize);
+    }
     ManifestRequester<S,C::ManifestRequired>::start();
 
+    // the received objects are stamped with their arrival time, 
+    // the clock starts before the threads that read it
+    Utils::start();
+    transport.setClock(&Utils::getMicroseconds);
     // start the transport
     transport.start();
     if(transport.isError()) {
@@ -108,7 +123,9 @@ template <typename S, typename I, typename C, typename L>
 void 
 SerializationManager<S,I,C,L>::stopLogger() 
 {
-    self().mDeserializer()->getLogger().stop();
+    if(self().mDeserializer) {
+        self().mDeserializer->stopLogger();
+    }
 }
 
 template <typename S, typename I, typename C, typename L>
@@ -141,6 +158,17 @@ SerializationManager<S,I,C,L>::send(TypeBase* d)
     }
 }
 
+template <typename S, typename I, typename C, typename L>
+typename SerializationManager<S,I,C,L>::LinkStatistics
+SerializationManager<S,I,C,L>::statistics()
+{
+    LinkStatistics stats;
+    if(self().mDeserializer) {
+        self().mDeserializer->statistics(stats);
+    }
+    return stats;
+}
+
 /////////////////////////////////////////////////////////
 //   Partial specialization of the class ManifestRe-   //
 //   quester for MANIFEST_REQUIRED configuration       //  
@@ -183,7 +211,7 @@ public:
         TypeRegistry::TypeDescriptorConstIt dit = TypeRegistry::descriptorBegin();
         TypeRegistry::TypeDescriptorConstIt edit = TypeRegistry::descriptorEnd();
         for(;  dit != edit; ++dit) {
-            typename SM::UnitType tId = dit->descriptor->typeId();
+            TypeDescriptorBase::IdType tId = dit->descriptor->typeId();
             TypeRegistry::acceptType(tId, tId);
         }
         TypeRegistry::setManifestReceived(true);
@@ -19,6 +19,9 @@ public:
     void send(TypeBase* d);
     void reset();
     void stop();
+    // objects the output queue dropped and the most it held
+    uint32_t droppedObjects() const;
+    uint32_t queueHighWater() const;
 private:
     template<typename TH, ConfigCommunication>
     class Helper 
@@ -27,6 +30,8 @@ private:
         Helper(const Serializer<T,C>* s);
         void send(TypeBase* d);
         void reset();
+        uint32_t droppedObjects() const;
+        uint32_t queueHighWater() const;
     };
 private:
     Transport&  mTransport;
@@ -49,6 +54,14 @@ public:
     {}
     void stop()
     {}
+    uint32_t droppedObjects() const
+    {
+        return 0;
+    }
+    uint32_t queueHighWater() const
+    {
+        return 0;
+    }
 };
 
 typedef Serializer<DummyType, DummyType> DummySerializer;
@@ -93,6 +106,20 @@ Serializer<T,C>::stop()
     mTransport.stop();
 }
 
+template <typename T, typename C>
+uint32_t 
+Serializer<T,C>::droppedObjects() const
+{
+    return mHelper.droppedObjects();
+}
+
+template <typename T, typename C>
+uint32_t 
+Serializer<T,C>::queueHighWater() const
+{
+    return mHelper.queueHighWater();
+}
+
 
 /////////////////////////////////////////////////////////
 //   Partial specialization of the helper class for    //
@@ -107,6 +134,8 @@ public:
     Helper(Serializer<T,C>& s);
     void send(TypeBase* d);
     void reset();
+    uint32_t droppedObjects() const;
+    uint32_t queueHighWater() const;
 private:
     Serializer<T,C>& mOwner;
 };
@@ -134,6 +163,22 @@ Serializer<T,C>::Helper<TH, COMMUNICATION_BLOCKING>::reset()
 {
 }
 
+template <typename T, typename C>
+template <typename TH>
+uint32_t 
+Serializer<T,C>::Helper<TH, COMMUNICATION_BLOCKING>::droppedObjects() const
+{
+    return 0;
+}
+
+template <typename T, typename C>
+template <typename TH>
+uint32_t 
+Serializer<T,C>::Helper<TH, COMMUNICATION_BLOCKING>::queueHighWater() const
+{
+    return 0;
+}
+
 
 /////////////////////////////////////////////////////////
 //   Partial specialization of the helper class for    //
@@ -147,13 +192,18 @@ class Serializer<T,C>::Helper<TH,COMMUNICATION_NONBLOCKING>
     typedef typename T::MutexType    MutexType;
     typedef typename T::CondType     CondType;
     typedef typename T::ThreadType   ThreadType;
-    typedef Queue<TypeBase,MutexType,CondType> QueueType;
+    typedef typename OutputQueueOf<TypeBase,MutexType,CondType,
+                                   C::OutputQueue>::QueueType QueueType;
     typedef typename QueueType::TypeList       QueueTypeList;
 public:
     Helper(Serializer<T,C>& s);
     void send(TypeBase* d);
     void reset();
+    uint32_t droppedObjects() const;
+    uint32_t queueHighWater() const;
     static bool serializerFunc(void*);
+private:
+    void write(QueueTypeList& dlist);
 private:
     Serializer<T,C>& mOwner;
     QueueType   mOutputQueue;
@@ -165,7 +215,7 @@ template <typename T, typename C>
 template <typename TH>
 Serializer<T,C>::Helper<TH, COMMUNICATION_NONBLOCKING>::Helper(Serializer<T,C>& s)
   : mOwner(s),
-    mOutputQueue(C::OutputQueueSize),
+    mOutputQueue(C::OutputQueueSize, C::OutputOverflow, C::QueueBlockMs),
     mSerializerThread("Serializer", 1524, C::BasePriority+1, serializerFunc, NULL, this)
 {
 }
@@ -175,6 +225,7 @@ template <typename TH>
 void
 Serializer<T,C>::Helper<TH, COMMUNICATION_NONBLOCKING>::send(TypeBase* d)
 {
+    // a full queue deletes what its policy drops
     mOutputQueue.push(d);
 }
 
@@ -186,19 +237,72 @@ Serializer<T,C>::Helper<TH, COMMUNICATION_NONBLOCKING>::reset()
     mOutputQueue.clear();
 }
 
+template <typename T, typename C>
+template <typename TH>
+uint32_t 
+Serializer<T,C>::Helper<TH, COMMUNICATION_NONBLOCKING>::droppedObjects() const
+{
+    return mOutputQueue.drops();
+}
+
+template <typename T, typename C>
+template <typename TH>
+uint32_t 
+Serializer<T,C>::Helper<TH, COMMUNICATION_NONBLOCKING>::queueHighWater() const
+{
+    return mOutputQueue.highWater();
+}
+
+template <typename T, typename C>
+template <typename TH>
+void
+Serializer<T,C>::Helper<TH, COMMUNICATION_NONBLOCKING>::write(QueueTypeList& dlist)
+{
+    if(C::Batching == BATCHING_ENABLED) {
+        mOwner.mTransport.serialize(dlist);
+    } else {
+        typename QueueTypeList::iterator it = dlist.begin();
+        typename QueueTypeList::iterator eit = dlist.end();
+        for(; it != eit; ++it) {
+            mOwner.mTransport.serialize(*it);
+        }
+    }
+    // data is in the transport, we can destroy the objects
+    typename QueueTypeList::iterator it = dlist.begin();
+    typename QueueTypeList::iterator eit = dlist.end();
+    for(; it != eit; ++it) {
+        delete *it;
+    }
+    dlist.clear();
+}
+
 template <typename T, typename C>
 template <typename TH>
 bool
 Serializer<T,C>::Helper<TH, COMMUNICATION_NONBLOCKING>::serializerFunc(void* param)
 {
+    typedef typename T::Utils Utils;
     Helper<TH,COMMUNICATION_NONBLOCKING>* h = (Helper<TH,COMMUNICATION_NONBLOCKING>*)param;
-    // pop the next object
-    TypeBase* d = h->mOutputQueue.pop();
-    //assert(d && d->desc());
-    // write it into the device
-    h->mOwner.mTransport.serialize(d);
-    // data is sent, we can destroy the object
-    delete d;
+    // take everything queued so far
+    QueueTypeList dlist;
+    h->mOutputQueue.popAll(dlist);
+    // the objects queued up behind each other, more are likely on 
+    // the way: the frames are held in the write buffer while more 
+    // keep coming, for at most MaxFlushDelayUs, and go out together 
+    // when it fills up or the queue runs empty. A lone object, a 
+    // ping, goes out right away.
+    bool burst = C::MaxFlushDelayUs > 0 && ++dlist.begin() != dlist.end();
+    if(!burst) {
+        h->write(dlist);
+        return false;
+    }
+    uint64_t end = Utils::getMicroseconds() + C::MaxFlushDelayUs;
+    h->mOwner.mTransport.holdWrites();
+    h->write(dlist);
+    while(Utils::getMicroseconds() < end && h->mOutputQueue.takeAll(dlist)) {
+        h->write(dlist);
+    }
+    h->mOwner.mTransport.releaseWrites();
     return false;
 }
 
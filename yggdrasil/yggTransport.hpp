@@ -3,6 +3,8 @@
 
 #include "yggTypes.hpp"
 #include "yggConfig.hpp"
+#include <list>
+#include <vector>
 
 namespace ygg
 {
@@ -10,10 +12,16 @@ namespace ygg
 class Transport 
 {
     template <typename T, typename S, typename I, typename L, typename C> friend class Deserializer;
+    template <ConfigEndianness E> friend class Encoder;
+    template <ConfigEndianness E> friend class Decoder;
+    friend class DeltaEncoder;
+    friend class DeltaDecoder;
+    friend class ObjectView;
 protected:
     typedef TypeBase::UnitType  UnitType;
+    typedef TypeBase::IdType    IdType;
     typedef uint32_t            SyncType;
-    typedef UnitType            ChecksumType;
+    typedef uint32_t            ChecksumType;
     enum DeviceState 
     {
         DEVICE_FUNCTIONAL,
@@ -23,7 +31,93 @@ protected:
     };
     enum 
     {
-        SYNC_BYTE = 0xAB
+        SYNC_BYTE       = 0xAB,
+        BATCH_SYNC_BYTE = 0xBA,
+        // extended header with flags, used only if the other end 
+        // announced one of the link options
+        EXT_SYNC_BYTE   = 0xAC
+    };
+    enum FrameFlag
+    {
+        FRAME_BATCH  = 0x01,
+        FRAME_VARINT = 0x02,
+        FRAME_LENGTH = 0x04,
+        // 16-bit type ids, in the header and before the batched objects
+        FRAME_WIDE_ID = 0x08,
+        // a per-link frame counter follows the type
+        FRAME_SEQUENCE = 0x10
+    };
+    enum
+    {
+        // frame length doesn't fit or the frame left the buffer 
+        // before it was complete
+        LENGTH_UNKNOWN = 0xFFFF
+    };
+    struct FrameHeader
+    {
+        UnitType flags;
+        // object type or the object count of batches
+        IdType   type;
+        UnitType seq;
+        // bytes following the header
+        uint32_t length;
+    };
+
+public:
+    typedef std::list<TypeBase*> TypeList;
+    // features the other end has announced in its manifest, 
+    // they are used only for writing, frames tell how they are encoded
+    enum LinkOption
+    {
+        LINK_VARINT = 0x01,
+        LINK_LENGTH = 0x02,
+        LINK_WIDE_ID = 0x04,
+        LINK_SEQUENCE = 0x08
+    };
+    // what happened to the frames of the other end, see 
+    // SerializationManager::statistics
+    struct LinkStatistics
+    {
+        LinkStatistics();
+        // noise skipped while looking for a frame header
+        uint32_t discardedBytes;
+        // frames that gave no objects
+        uint32_t droppedFrames;
+        // with LINK_SEQUENCE only: frames that arrived intact, the gaps 
+        // in their numbers (frames missing or broken), repeated numbers 
+        // and frames arriving after a later one (not counted as lost)
+        uint32_t receivedFrames;
+        uint32_t lostFrames;
+        uint32_t duplicatedFrames;
+        uint32_t reorderedFrames;
+        // objects dropped because the input or output queue was full
+        // and the most each queue ever held
+        uint32_t inputQueueDrops;
+        uint32_t outputQueueDrops;
+        uint32_t inputQueueHighWater;
+        uint32_t outputQueueHighWater;
+    };
+    // how the fields of the current object can be accessed inline,
+    // see Encodable
+    enum Codec
+    {
+        CODEC_NATIVE,
+        CODEC_SWAP,
+        CODEC_GENERIC,
+        // the type is delta coded, see DeltaEncoder
+        CODEC_DELTA
+    };
+    // the last object of a delta coded type, per direction
+    struct DeltaState
+    {
+        DeltaState();
+        // sequence number of the next object
+        UnitType              seq;
+        // objects since the last keyframe
+        uint32_t              sinceKey;
+        // the receiver has the keyframe the deltas refer to
+        bool                  valid;
+        std::vector<uint64_t> values;
     };
 
 public:
@@ -51,12 +145,38 @@ public:
     void read(float& floatd);
     void read(double& doubled);
     void read(std::string& stringd);
+    // the string stays in the read buffer, valid until the next read
+    bool readView(const char*& str, uint32_t& len);
 
     template <class T> void readChecksumed(T& td);
     template <class T> void writeChecksumed(const T& td);
 
+    // arrays go to and from the buffers in bulk
+    void writeArray(const uint64_t* ptr, uint32_t n);
+    void writeArray(const int64_t* ptr, uint32_t n);
+    void writeArray(const uint32_t* ptr, uint32_t n);
+    void writeArray(const int32_t* ptr, uint32_t n);
+    void writeArray(const uint16_t* ptr, uint32_t n);
+    void writeArray(const int16_t* ptr, uint32_t n);
+    void writeArray(const uint8_t* ptr, uint32_t n);
+    void writeArray(const int8_t* ptr, uint32_t n);
+    void writeArray(const float* ptr, uint32_t n);
+    void writeArray(const double* ptr, uint32_t n);
+
+    void readArray(uint64_t* ptr, uint32_t n);
+    void readArray(int64_t* ptr, uint32_t n);
+    void readArray(uint32_t* ptr, uint32_t n);
+    void readArray(int32_t* ptr, uint32_t n);
+    void readArray(uint16_t* ptr, uint32_t n);
+    void readArray(int16_t* ptr, uint32_t n);
+    void readArray(uint8_t* ptr, uint32_t n);
+    void readArray(int8_t* ptr, uint32_t n);
+    void readArray(float* ptr, uint32_t n);
+    void readArray(double* ptr, uint32_t n);
+
 public:
-    Transport();
+    Transport(uint8_t* writeBuffer, uint32_t writeBufferSize,
+              uint8_t* readBuffer,  uint32_t readBufferSize);
     virtual void start() = 0;
     virtual void stop() = 0;
     // status checking
@@ -68,37 +188,298 @@ public:
     void setStopped();
     bool isWaitSync() const;
     void setWaitSync();
+    // link options
+    virtual uint32_t supportedLinkOptions() const = 0;
+    uint32_t linkOptions() const;
+    void acceptLinkOptions(uint32_t options);
+    // how the fields of the object being written or read are coded,
+    // the two directions may run on different threads
+    Codec writeCodec() const;
+    Codec readCodec() const;
+    // starts a delta coded object, the reader gets NULL if the 
+    // object can't be decoded
+    DeltaState& beginWriteDelta(IdType type);
+    DeltaState* beginReadDelta(IdType type);
+    // reception statistics, noise skipped while looking for a 
+    // frame header and frames that gave no objects
+    uint32_t discardedBytes() const;
+    uint32_t droppedFrames() const;
+    // the transport's part of the statistics
+    void     statistics(LinkStatistics& stats) const;
+    // the received objects are stamped with the clock's time 
+    // at the sync of their frame, there is no stamp without it
+    typedef uint64_t (*Clock)();
+    void     setClock(Clock clock);
+    // while held the complete frames stay in the write buffer and 
+    // go out together when it fills up or at the release
+    void     holdWrites();
+    void     releaseWrites();
 
     // writing serializable objects
     void serialize(const TypeBase* d);
+    // writing several objects in batch frames
+    void serialize(const TypeList& dlist);
+    // writing an object received elsewhere as it was received
+    void serialize(const ObjectView& view);
     // reading serializable objects
     void deserialize(TypeBase*& d);
+    // same, but a single object in a frame checked as a whole is left 
+    // in the read buffer and described by view, d stays NULL then
+    void deserialize(TypeBase*& d, ObjectView& view);
 
 protected:
-    UnitType  readObjectType();
-    TypeBase* buildObject(UnitType fType);
-    template <ConfigEndianness E, int L> void fixEndianness(void* ptr);
-    virtual void write(const void* ptr, uint32_t size) = 0;
-    virtual void read(void* ptr, uint32_t size) = 0;
-    ChecksumType calculateChecksum8(const void* ptr);
-    ChecksumType calculateChecksum16(const void* ptr);
-    ChecksumType calculateChecksum32(const void* ptr);
-    ChecksumType calculateChecksum64(const void* ptr);
-    ChecksumType calculateChecksumN(const void* ptr, uint32_t size);
+    bool      readFrameHeader(FrameHeader& h);
+    uint32_t  parseFrameHeader(FrameHeader& h);
+    void      readFrame(const FrameHeader& h, TypeBase*& d);
+    TypeBase* buildObject(IdType fType, bool varintFrame);
+    void      buildBatch(UnitType count, UnitType flags);
+    bool      buildView(IdType fType, bool varintFrame, uint32_t payloadEnd);
+    void      clearBatch();
+    UnitType  frameFlags() const;
+    UnitType  supportedFrameFlags() const;
+    void      beginFrame(UnitType flags, IdType t);
+    // the type ids other than the frame's own, in batches
+    void      writeTypeId(IdType t, bool wide);
+    void      readTypeId(IdType& t, bool wide);
+    void      accountSequence(UnitType seq);
+    void      endFrame();
+    void      selectWriteEncoding(bool varintFrame, const TypeBase* d);
+    void      selectReadEncoding(bool varintFrame, const TypeBase* d);
+    template <ConfigEndianness E, int L> static void fixEndianness(void* ptr);
+    void writeVarint(uint64_t v);
+    bool readVarint(uint64_t& v, uint32_t maxSize);
+    // stages the data in the write buffer, nothing goes to the 
+    // device until the buffer is full or the frame is complete
+    void write(const void* ptr, uint32_t size);
+    void flush();
+    // sends the staged bytes followed by ptr, COBS-encoded if 
+    // configured, in a single gathered write otherwise
+    void flush(const void* ptr, uint32_t size);
+    virtual void deviceWrite(const void* ptr, uint32_t size) = 0;
+    virtual void deviceWrite(const IoChunk* chunks, uint32_t count) = 0;
+    // COBS framing, frames are encoded on the way to the device 
+    // and decoded in place in the read buffer
+    void     cobsEncode(const void* ptr, uint32_t size);
+    void     cobsFlush();
+    void     cobsEndFrame();
+    bool     readCobsFrame(TypeBase*& d);
+    static uint32_t cobsDecode(uint8_t* ptr, uint32_t size);
+    // decodes from the read buffer, the device is accessed only 
+    // when the buffered data runs out
+    void read(void* ptr, uint32_t size);
+    bool fill();
+    // makes size bytes available in the buffer after the read position
+    bool readAhead(uint32_t size);
+    // drops size bytes, whether buffered or not
+    void skip(uint32_t size);
+    // longer strings are treated as a corrupted frame
+    uint32_t readStringLength();
+    // byte swapping variants working directly on the buffers
+    template <int L> void writeSwapped(const void* ptr, uint32_t n);
+    template <int L> void readSwapped(void* ptr, uint32_t n);
+    // reads whatever the device has (at least one byte), returns 0 on error
+    virtual uint32_t deviceRead(void* ptr, uint32_t size) = 0;
+    // frame checksum, it is computed over the buffered frame bytes 
+    // between begin and end using the configured integrity check
+    void beginWriteChecksum();
+    void endWriteChecksum();
+    void updateWriteChecksum();
+    void beginReadChecksum();
+    bool endReadChecksum();
+    void updateReadChecksum();
+    virtual ChecksumType initialChecksum() = 0;
+    virtual ChecksumType calculateChecksum(ChecksumType cs, const void* ptr, uint32_t size) = 0;
+    virtual uint32_t checksumSize() const = 0;
+    virtual void writeChecksum(ChecksumType cs) = 0;
+    virtual bool readChecksum(ChecksumType cs) = 0;
+    // 8-bit sum used for the headers and the checksumed values
+    UnitType calculateChecksumN(const void* ptr, uint32_t size);
 
 protected:
     virtual void fixEndianness16(void* ptr) = 0;
     virtual void fixEndianness32(void* ptr) = 0;
     virtual void fixEndianness64(void* ptr) = 0;
+    virtual void writeArray16(const void* ptr, uint32_t n) = 0;
+    virtual void writeArray32(const void* ptr, uint32_t n) = 0;
+    virtual void writeArray64(const void* ptr, uint32_t n) = 0;
+    virtual void readArray16(void* ptr, uint32_t n) = 0;
+    virtual void readArray32(void* ptr, uint32_t n) = 0;
+    virtual void readArray64(void* ptr, uint32_t n) = 0;
+    virtual void writeInteger16(uint16_t v, bool isSigned) = 0;
+    virtual void writeInteger32(uint32_t v, bool isSigned) = 0;
+    virtual void writeInteger64(uint64_t v, bool isSigned) = 0;
+    virtual void readInteger16(uint16_t& v, bool isSigned) = 0;
+    virtual void readInteger32(uint32_t& v, bool isSigned) = 0;
+    virtual void readInteger64(uint64_t& v, bool isSigned) = 0;
     virtual void swap(Transport& transport);
 
 protected:
     DeviceState   mState;
     ChecksumType  mReadChecksum;
     ChecksumType  mWriteChecksum;
+    uint8_t*      mWriteBuffer;
+    uint32_t      mWriteBufferSize;
+    uint32_t      mWriteSize;
+    uint8_t*      mReadBuffer;
+    uint32_t      mReadBufferSize;
+    uint32_t      mReadPos;
+    uint32_t      mReadEnd;
+    uint32_t      mWriteChecksumPos;
+    uint32_t      mReadChecksumPos;
+    bool          mWriteChecksumOn;
+    bool          mReadChecksumOn;
+    uint32_t      mLinkOptions;
+    // integers of the object being written or read go as varints
+    bool          mWriteVarint;
+    bool          mReadVarint;
+    Codec         mFixedCodec;
+    uint32_t      mMaxStringLength;
+    // header of the frame being written, its length 
+    // is filled in if it is still in the buffer at the end
+    uint32_t      mFrameHeaderPos;
+    uint32_t      mFrameHeaderSize;
+    bool          mFrameLengthPending;
+    // complete frames are kept in front of it, see holdWrites
+    bool          mWritesHeld;
+    // reading is limited to the buffered frame
+    bool          mReadBounded;
+    uint32_t      mDiscardedBytes;
+    uint32_t      mDroppedFrames;
+    // sequence numbers, the next to write and the state of the 
+    // reception: the next expected one and a bit for each of the 
+    // 32 before it, set if that frame arrived, and another set 
+    // if it was counted as lost
+    UnitType      mWriteSeq;
+    UnitType      mReadSeq;
+    uint32_t      mReadSeqWindow;
+    uint32_t      mReadSeqLost;
+    bool          mReadSeqStarted;
+    // the frame being read carries mFrameSeq
+    bool          mFrameSequenced;
+    UnitType      mFrameSeq;
+    uint32_t      mReceivedFrames;
+    uint32_t      mLostFrames;
+    uint32_t      mDuplicatedFrames;
+    uint32_t      mReorderedFrames;
+    Clock         mClock;
+    // arrival time of the frame being read
+    uint64_t      mFrameTime;
+    // filled instead of building the object, if set
+    ObjectView*   mView;
+    // decodes the views with a state of its own, NULL without views
+    Transport*    mViewReader;
+    // frames are COBS-encoded and end with a zero
+    bool          mCobs;
+    uint8_t*      mCobsBuffer;
+    uint32_t      mCobsBufferSize;
+    uint32_t      mCobsSize;
+    // the code byte of the block being encoded
+    uint32_t      mCobsCodePos;
+    // objects of the last batch frame not handed out yet
+    TypeList      mBatchObjects;
+    // the object being written or read is delta coded
+    bool          mWriteDelta;
+    bool          mReadDelta;
+    uint32_t      mDeltaKeyInterval;
+    // indexed by the own type id
+    std::vector<DeltaState> mWriteDeltas;
+    std::vector<DeltaState> mReadDeltas;
+    // set by acceptLinkOptions, whatever thread it runs on, the 
+    // write and read state is reset by the thread it belongs to
+    volatile bool mWriteResetPending;
+    volatile bool mReadResetPending;
+};
+
+
+
+// An object left in the read buffer of the transport that received 
+// it. Valid until the transport reads again, the fields are decoded 
+// on access, see View<Type>. Like the buffer it belongs to the thread 
+// reading the transport.
+class ObjectView
+{
+    friend class Transport;
+public:
+    typedef TypeBase::IdType IdType;
+public:
+    ObjectView();
+    bool           isValid() const;
+    IdType         id() const;
+    uint64_t       arrivalTime() const;
+    // the serialized object, in the coding of the link
+    const uint8_t* data() const;
+    uint32_t       size() const;
+    // reads the object from offset bytes in, reads past its end fail,
+    // the transport's own reading isn't affected
+    Transport&     reader(uint32_t offset = 0) const;
+    // integers are varints, their offsets aren't known in advance
+    bool           isVarint() const;
+    // the object decoded to the heap, for the handlers that keep it
+    TypeBase*      instantiate() const;
+private:
+    Transport* mTransport;
+    uint32_t   mBegin;
+    uint32_t   mSize;
+    IdType     mId;
+    bool       mVarint;
+    uint64_t   mArrivalTime;
 };
 
+// device of the view readers, what they read is buffered already
+class ViewDevice
+{
+public:
+    bool isOpen()
+    {
+        return true;
+    }
+    bool write(const uint8_t*, uint32_t)
+    {
+        return false;
+    }
+    bool write(const IoChunk*, uint32_t)
+    {
+        return false;
+    }
+    uint32_t readSome(uint8_t*, uint32_t)
+    {
+        return 0;
+    }
+};
 
+// the view readers read the buffer of their transport, they need 
+// none of their own and no views
+template <typename C>
+struct ViewConfig : public C
+{
+    const static int           WriteBufferSize = 1;
+    const static int           ReadBufferSize  = 1;
+    const static ConfigFraming Framing         = FRAMING_SYNC;
+    const static ConfigViews   Views           = VIEWS_DISABLED;
+};
+
+template <typename C, typename D> class ConfiguredTransport;
+
+// the view reader kept by the transports of configuration C
+template <typename C, ConfigViews V = C::Views>
+struct ViewReader
+{
+    typedef DummyType Type;
+    static Transport* get(Type&)
+    {
+        return NULL;
+    }
+};
+
+template <typename C>
+struct ViewReader<C, VIEWS_ENABLED>
+{
+    typedef ConfiguredTransport<ViewConfig<C>, ViewDevice> Type;
+    static Transport* get(Type& reader)
+    {
+        return &reader;
+    }
+};
 
 template <typename C, typename D>
 class ConfiguredTransport : public Transport
@@ -108,14 +489,47 @@ public:
     virtual void start();
     virtual void stop();
     virtual void swap(ConfiguredTransport<C,D>& transport);
+    virtual uint32_t supportedLinkOptions() const;
 protected:
     virtual void fixEndianness16(void* ptr);
     virtual void fixEndianness32(void* ptr);
     virtual void fixEndianness64(void* ptr);
-    virtual void write(const void* ptr, uint32_t size);
-    virtual void read(void* ptr, uint32_t size);
+    virtual void writeArray16(const void* ptr, uint32_t n);
+    virtual void writeArray32(const void* ptr, uint32_t n);
+    virtual void writeArray64(const void* ptr, uint32_t n);
+    virtual void readArray16(void* ptr, uint32_t n);
+    virtual void readArray32(void* ptr, uint32_t n);
+    virtual void readArray64(void* ptr, uint32_t n);
+    template <int L> void writeFixedArray(const void* ptr, uint32_t n);
+    template <int L> void readFixedArray(void* ptr, uint32_t n);
+    virtual void writeInteger16(uint16_t v, bool isSigned);
+    virtual void writeInteger32(uint32_t v, bool isSigned);
+    virtual void writeInteger64(uint64_t v, bool isSigned);
+    virtual void readInteger16(uint16_t& v, bool isSigned);
+    virtual void readInteger32(uint32_t& v, bool isSigned);
+    virtual void readInteger64(uint64_t& v, bool isSigned);
+    template <typename T> void writeInteger(T v, bool isSigned);
+    template <typename T> void readInteger(T& v, bool isSigned);
+    virtual void deviceWrite(const void* ptr, uint32_t size);
+    virtual void deviceWrite(const IoChunk* chunks, uint32_t count);
+    virtual uint32_t deviceRead(void* ptr, uint32_t size);
+    virtual ChecksumType initialChecksum();
+    virtual ChecksumType calculateChecksum(ChecksumType cs, const void* ptr, uint32_t size);
+    virtual uint32_t checksumSize() const;
+    virtual void writeChecksum(ChecksumType cs);
+    virtual bool readChecksum(ChecksumType cs);
 protected:
     D* mDevice;
+    // frame staging area, see Transport::write
+    uint8_t mWriteStorage[C::WriteBufferSize];
+    // receive buffer, see Transport::read
+    uint8_t mReadStorage[C::ReadBufferSize];
+    // encoded frames, big enough for a full staging buffer 
+    // and the block still waiting for its code
+    uint8_t mCobsStorage[(C::Framing == FRAMING_COBS) ? 
+                         C::WriteBufferSize + C::WriteBufferSize / 254 + 256 : 1];
+    // see ObjectView::reader
+    typename ViewReader<C>::Type mViewReaderStorage;
 };
 
 
@@ -128,6 +542,8 @@ class ConfiguredTransport<C, DummyDevice>
 public:
     void serialize(const TypeBase*)
     {}
+    void serialize(const ObjectView&)
+    {}
     void deserialize(TypeBase*&)
     {}
     
@@ -2,17 +2,92 @@
 #define YGG_TRANSPORT_IMPL_HPP
 
 #include "yggTypeRegistry.hpp"
+#include "yggIntegrity.hpp"
+#include "yggByteSwap.hpp"
+#include "yggByteScan.hpp"
 #include <cassert>
+#include <cstring>
+#include <algorithm>
 
 
 namespace ygg
 {
 
 inline
-Transport::Transport()
+Transport::Transport(uint8_t* writeBuffer, uint32_t writeBufferSize,
+                     uint8_t* readBuffer,  uint32_t readBufferSize)
  : mState(DEVICE_STOPPED),
    mReadChecksum(0),
-   mWriteChecksum(0)
+   mWriteChecksum(0),
+   mWriteBuffer(writeBuffer),
+   mWriteBufferSize(writeBufferSize),
+   mWriteSize(0),
+   mReadBuffer(readBuffer),
+   mReadBufferSize(readBufferSize),
+   mReadPos(0),
+   mReadEnd(0),
+   mWriteChecksumPos(0),
+   mReadChecksumPos(0),
+   mWriteChecksumOn(false),
+   mReadChecksumOn(false),
+   mLinkOptions(0),
+   mWriteVarint(false),
+   mReadVarint(false),
+   mFixedCodec(CODEC_GENERIC),
+   mMaxStringLength(std::numeric_limits<uint32_t>::max()),
+   mFrameHeaderPos(0),
+   mFrameHeaderSize(0),
+   mFrameLengthPending(false),
+   mWritesHeld(false),
+   mReadBounded(false),
+   mDiscardedBytes(0),
+   mDroppedFrames(0),
+   mWriteSeq(0),
+   mReadSeq(0),
+   mReadSeqWindow(0),
+   mReadSeqLost(0),
+   mReadSeqStarted(false),
+   mFrameSequenced(false),
+   mFrameSeq(0),
+   mReceivedFrames(0),
+   mLostFrames(0),
+   mDuplicatedFrames(0),
+   mReorderedFrames(0),
+   mClock(NULL),
+   mFrameTime(0),
+   mView(NULL),
+   mViewReader(NULL),
+   mCobs(false),
+   mCobsBuffer(NULL),
+   mCobsBufferSize(0),
+   mCobsSize(1),
+   mCobsCodePos(0),
+   mWriteDelta(false),
+   mReadDelta(false),
+   mDeltaKeyInterval(1),
+   mWriteResetPending(false),
+   mReadResetPending(false)
+{}
+
+inline
+Transport::LinkStatistics::LinkStatistics()
+ : discardedBytes(0),
+   droppedFrames(0),
+   receivedFrames(0),
+   lostFrames(0),
+   duplicatedFrames(0),
+   reorderedFrames(0),
+   inputQueueDrops(0),
+   outputQueueDrops(0),
+   inputQueueHighWater(0),
+   outputQueueHighWater(0)
+{}
+
+inline
+Transport::DeltaState::DeltaState()
+ : seq(0),
+   sinceKey(0),
+   valid(false)
 {}
 
 
@@ -64,98 +139,669 @@ Transport::setWaitSync()
     mState = DEVICE_WAITING_SYNC;
 }
 
+inline uint32_t
+Transport::linkOptions() const
+{
+    return mLinkOptions;
+}
+
+inline void
+Transport::acceptLinkOptions(uint32_t options)
+{
+    mLinkOptions = options & supportedLinkOptions();
+    // the other end (re)started, it needs keyframes and counts its
+    // frames from anywhere; the state belongs to the writing and 
+    // the reading thread, they reset it before their next frame
+    mWriteResetPending = true;
+    mReadResetPending = true;
+}
+
+inline Transport::Codec
+Transport::writeCodec() const
+{
+    if(mWriteDelta) {
+        return CODEC_DELTA;
+    }
+    return mWriteVarint ? CODEC_GENERIC : mFixedCodec;
+}
+
+inline Transport::Codec
+Transport::readCodec() const
+{
+    if(mReadDelta) {
+        return CODEC_DELTA;
+    }
+    return mReadVarint ? CODEC_GENERIC : mFixedCodec;
+}
+
+inline Transport::DeltaState&
+Transport::beginWriteDelta(IdType type)
+{
+    if(type >= mWriteDeltas.size()) {
+        mWriteDeltas.resize(type + 1);
+    }
+    DeltaState& state = mWriteDeltas[type];
+    // the first object and every mDeltaKeyInterval-th one 
+    // are keyframes, their fields are differences to zero
+    bool key = !state.valid || state.sinceKey >= mDeltaKeyInterval;
+    if(key) {
+        state.values.clear();
+        state.sinceKey = 0;
+        state.valid = true;
+    }
+    write((UnitType)((key ? 0x80 : 0) | (state.seq & 0x7F)));
+    ++state.seq;
+    ++state.sinceKey;
+    return state;
+}
+
+inline Transport::DeltaState*
+Transport::beginReadDelta(IdType type)
+{
+    UnitType header;
+    read(header);
+    if(type >= mReadDeltas.size()) {
+        mReadDeltas.resize(type + 1);
+    }
+    DeltaState& state = mReadDeltas[type];
+    if(header & 0x80) {
+        state.values.clear();
+        state.valid = true;
+    } else if(!state.valid || (header & 0x7F) != (state.seq & 0x7F)) {
+        // an object of the type was lost, nothing is 
+        // decoded until the next keyframe
+        state.valid = false;
+        setWaitSync();
+        return NULL;
+    }
+    state.seq = (header & 0x7F) + 1;
+    return &state;
+}
+
+inline uint32_t
+Transport::discardedBytes() const
+{
+    return mDiscardedBytes;
+}
+
+inline uint32_t
+Transport::droppedFrames() const
+{
+    return mDroppedFrames;
+}
+
+inline void
+Transport::statistics(LinkStatistics& stats) const
+{
+    stats.discardedBytes = mDiscardedBytes;
+    stats.droppedFrames = mDroppedFrames;
+    stats.receivedFrames = mReceivedFrames;
+    stats.lostFrames = mLostFrames;
+    stats.duplicatedFrames = mDuplicatedFrames;
+    stats.reorderedFrames = mReorderedFrames;
+}
+
+inline void
+Transport::setClock(Clock clock)
+{
+    mClock = clock;
+}
+
+inline void
+Transport::accountSequence(UnitType seq)
+{
+    if(!mReadSeqStarted) {
+        mReadSeqStarted = true;
+        mReadSeq = seq + 1;
+        mReadSeqWindow = 1;
+        mReadSeqLost = 0;
+        ++mReceivedFrames;
+        return;
+    }
+    UnitType ahead = seq - mReadSeq;
+    if(ahead < 0x80) {
+        // the frames in between are missing
+        mLostFrames += ahead;
+        if(ahead < 31) {
+            mReadSeqWindow = (mReadSeqWindow << (ahead + 1)) | 1;
+            mReadSeqLost = (mReadSeqLost << (ahead + 1)) | (((1U << ahead) - 1) << 1);
+        } else {
+            mReadSeqWindow = 1;
+            mReadSeqLost = ~1U;
+        }
+        mReadSeq = seq + 1;
+        ++mReceivedFrames;
+        return;
+    }
+    UnitType behind = mReadSeq - 1 - seq;
+    if(behind >= 32) {
+        // too old to tell, the other end probably restarted
+        mReadSeq = seq + 1;
+        mReadSeqWindow = 1;
+        mReadSeqLost = 0;
+        ++mReceivedFrames;
+    } else if(mReadSeqLost & (1U << behind)) {
+        // counted as lost when the later frame came
+        mReadSeqWindow |= 1U << behind;
+        mReadSeqLost &= ~(1U << behind);
+        ++mReorderedFrames;
+        --mLostFrames;
+        ++mReceivedFrames;
+    } else {
+        // arrived already, or sent before the other end restarted
+        ++mDuplicatedFrames;
+    }
+}
+
+inline void
+Transport::selectWriteEncoding(bool varintFrame, const TypeBase* d)
+{
+    // system objects are always written the same way, 
+    // the manifest has to be readable before anything is agreed on
+    mWriteVarint = varintFrame && !TypeRegistry::isSystemType(d->id());
+    mWriteDelta = TypeRegistry::isDeltaType(d->id());
+}
+
+inline void
+Transport::selectReadEncoding(bool varintFrame, const TypeBase* d)
+{
+    mReadVarint = varintFrame && !TypeRegistry::isSystemType(d->id());
+    mReadDelta = TypeRegistry::isDeltaType(d->id());
+}
+
+inline Transport::UnitType
+Transport::frameFlags() const
+{
+    UnitType flags = 0;
+    if(mLinkOptions & LINK_VARINT) {
+        flags |= FRAME_VARINT;
+    }
+    if(mLinkOptions & LINK_LENGTH) {
+        flags |= FRAME_LENGTH;
+    }
+    if(mLinkOptions & LINK_SEQUENCE) {
+        flags |= FRAME_SEQUENCE;
+    }
+    return flags;
+}
+
+inline Transport::UnitType
+Transport::supportedFrameFlags() const
+{
+    // frames with the other flags can't be decoded, only skipped
+    UnitType flags = FRAME_BATCH | FRAME_LENGTH | FRAME_WIDE_ID | FRAME_SEQUENCE;
+    if(supportedLinkOptions() & LINK_VARINT) {
+        flags |= FRAME_VARINT;
+    }
+    return flags;
+}
+
+inline void
+Transport::beginFrame(UnitType flags, IdType t)
+{
+    if(mWriteResetPending) {
+        mWriteResetPending = false;
+        mWriteDeltas.clear();
+    }
+    uint8_t header[8];
+    uint32_t size = 0;
+    if(flags & ~FRAME_BATCH) {
+        header[size++] = EXT_SYNC_BYTE;
+        header[size++] = flags;
+    } else {
+        header[size++] = (flags & FRAME_BATCH) ? BATCH_SYNC_BYTE : SYNC_BYTE;
+    }
+    header[size++] = t & 0xFF;
+    if(flags & FRAME_WIDE_ID) {
+        header[size++] = t >> 8;
+    }
+    if(flags & FRAME_SEQUENCE) {
+        header[size++] = mWriteSeq++;
+    }
+    if(flags & FRAME_LENGTH) {
+        // patched in endFrame if the frame fits the write buffer
+        header[size++] = LENGTH_UNKNOWN & 0xFF;
+        header[size++] = LENGTH_UNKNOWN >> 8;
+    }
+    // the header bytes sum up to 255
+    header[size] = 255 - calculateChecksumN(header, size);
+    ++size;
+    write(header, size);
+    mFrameHeaderSize = size;
+    mFrameHeaderPos = mWriteSize - size;
+    mFrameLengthPending = flags & FRAME_LENGTH;
+    // start the checksum, it covers everything the objects write
+    beginWriteChecksum();
+}
+
+inline void
+Transport::endFrame()
+{
+    // write the calculated checksum
+    endWriteChecksum();
+    if(mFrameLengthPending) {
+        uint32_t length = mWriteSize - mFrameHeaderPos - mFrameHeaderSize;
+        if(length < LENGTH_UNKNOWN) {
+            // the length is right before the header checksum
+            uint8_t* header = mWriteBuffer + mFrameHeaderPos;
+            uint32_t sumPos = mFrameHeaderSize - 1;
+            header[sumPos - 2] = length & 0xFF;
+            header[sumPos - 1] = length >> 8;
+            header[sumPos] = 255 - calculateChecksumN(header, sumPos);
+        }
+        mFrameLengthPending = false;
+    }
+    // the frame is complete, send it to the device in one go
+    // unless the writes are held, COBS frames are encoded anyway
+    mFrameHeaderPos = 0;
+    if(mCobs) {
+        flush();
+        cobsEndFrame();
+    } else if(!mWritesHeld) {
+        flush();
+    }
+}
+
+inline void
+Transport::holdWrites()
+{
+    mWritesHeld = true;
+}
+
+inline void
+Transport::releaseWrites()
+{
+    mWritesHeld = false;
+    if(mCobs) {
+        if(mCobsCodePos) {
+            cobsFlush();
+        }
+    } else {
+        flush();
+    }
+}
+
 inline void 
 Transport::serialize(const TypeBase* d)
 {
     //assert(d && d->desc());
-    UnitType typeId = d->id();
-    // write the synchronization byte
-    write((UnitType)SYNC_BYTE);
-    // write the type
-    write(typeId);
-    // write the checksum
-    UnitType cs = 255 - typeId - SYNC_BYTE;
-    write(cs);
-    // reset the checksum, we will be using it when dumping the object
-    mWriteChecksum = 0;
+    IdType typeId = d->id();
+    UnitType flags = frameFlags();
+    if(typeId >= TypeBase::WIDE_ID_BEGIN) {
+        if(!(mLinkOptions & LINK_WIDE_ID)) {
+            // the other end has no record of the type
+            return;
+        }
+        flags |= FRAME_WIDE_ID;
+    }
+    beginFrame(flags, typeId);
+    selectWriteEncoding(flags & FRAME_VARINT, d);
     d->write(*this);
-    // write the calculated checksum
-    write(mWriteChecksum);
+    endFrame();
 }
 
-inline Transport::UnitType 
-Transport::readObjectType()
+inline void 
+Transport::serialize(const ObjectView& view)
 {
-    UnitType s, t, cs;
-    // read the first byte, we hope this is the sync.
-    read(s);
-    while (isWaitSync()) {
-        if(s == SYNC_BYTE) {
-            // ok check the next one, it should be the data type byte
-            read(t);
-            if(!TypeRegistry::isForeignTypeEnabled(t)) {
-                // nope, continue search
-                s = t;
-                continue;
+    // the bytes go as they are, in the coding they came in
+    UnitType flags = frameFlags() & ~FRAME_VARINT;
+    if(view.mVarint) {
+        flags |= FRAME_VARINT;
+    }
+    if(view.mId >= TypeBase::WIDE_ID_BEGIN) {
+        if(!(mLinkOptions & LINK_WIDE_ID)) {
+            return;
+        }
+        flags |= FRAME_WIDE_ID;
+    }
+    beginFrame(flags, view.mId);
+    write(view.data(), view.size());
+    endFrame();
+}
+
+inline void 
+Transport::serialize(const TypeList& dlist)
+{
+    TypeList::const_iterator dit = dlist.begin();
+    uint32_t left = dlist.size();
+    UnitType flags = frameFlags() | FRAME_BATCH;
+    while(left) {
+        if(left == 1) {
+            // no need for a batch frame
+            serialize(*dit);
+            break;
+        }
+        UnitType count = std::min(left, (uint32_t)std::numeric_limits<UnitType>::max());
+        UnitType batchFlags = flags;
+        TypeList::const_iterator it = dit;
+        for(UnitType i = 0; i < count; ++i, ++it) {
+            if((*it)->id() >= TypeBase::WIDE_ID_BEGIN) {
+                batchFlags |= FRAME_WIDE_ID;
             }
-            // ok, so far so good, read the checksum
-            read(cs);
-            if(cs + s + t != 255) {
-                // checksum didn't match, continue from here
-                s = cs;
-                continue;
+        }
+        if((batchFlags & FRAME_WIDE_ID) && !(mLinkOptions & LINK_WIDE_ID)) {
+            // one by one, the objects the other end can't know are dropped
+            for(UnitType i = 0; i < count; ++i, ++dit) {
+                serialize(*dit);
             }
+            left -= count;
+            continue;
+        }
+        // same header as for single objects but carrying 
+        // the number of objects instead of the type, 
+        // one checksum for the whole batch
+        beginFrame(batchFlags, count);
+        for(UnitType i = 0; i < count; ++i, ++dit) {
+            writeTypeId((*dit)->id(), batchFlags & FRAME_WIDE_ID);
+            selectWriteEncoding(batchFlags & FRAME_VARINT, *dit);
+            (*dit)->write(*this);
+        }
+        endFrame();
+        left -= count;
+    }
+}
+
+inline bool
+Transport::readFrameHeader(FrameHeader& h)
+{
+    while (isWaitSync()) {
+        if(mReadPos == mReadEnd && !fill()) {
+            break;
+        }
+        // jump over everything that can't start a header
+        uint32_t noise = ByteScan<SYNC_BYTE, BATCH_SYNC_BYTE, EXT_SYNC_BYTE>::find(
+                             mReadBuffer + mReadPos, mReadEnd - mReadPos);
+        mReadPos += noise;
+        mDiscardedBytes += noise;
+        if(mReadPos == mReadEnd) {
+            continue;
+        }
+        mFrameTime = mClock ? mClock() : 0;
+        uint32_t size = parseFrameHeader(h);
+        if(size) {
             // we are good to go!
+            mReadPos += size;
             setFunctional();
-            break;
+            return true;
         }
-        read(s);
+        // no frame starts here, continue the search from the next byte
+        ++mReadPos;
+        ++mDiscardedBytes;
     }
-    return t;
+    return false;
+}
+
+inline uint32_t
+Transport::parseFrameHeader(FrameHeader& h)
+{
+    UnitType s = mReadBuffer[mReadPos];
+    if(s != SYNC_BYTE && s != BATCH_SYNC_BYTE && s != EXT_SYNC_BYTE) {
+        return 0;
+    }
+    // sync, [flags], type or count, [length], checksum
+    uint32_t size = 3;
+    h.flags = (s == BATCH_SYNC_BYTE) ? FRAME_BATCH : 0;
+    h.length = LENGTH_UNKNOWN;
+    if(s == EXT_SYNC_BYTE) {
+        if(!readAhead(2)) {
+            return 0;
+        }
+        h.flags = mReadBuffer[mReadPos + 1];
+        if(h.flags & ~(FRAME_BATCH | FRAME_VARINT | FRAME_LENGTH | 
+                       FRAME_WIDE_ID | FRAME_SEQUENCE)) {
+            return 0;
+        }
+        size = 4 + ((h.flags & FRAME_WIDE_ID) ? 1 : 0) + 
+                   ((h.flags & FRAME_SEQUENCE) ? 1 : 0) + 
+                   ((h.flags & FRAME_LENGTH) ? 2 : 0);
+    }
+    if(!readAhead(size)) {
+        return 0;
+    }
+    const uint8_t* header = mReadBuffer + mReadPos;
+    if(calculateChecksumN(header, size) != 255) {
+        return 0;
+    }
+    // the type is after the sync byte and the flags, if any
+    uint32_t typePos = (s == EXT_SYNC_BYTE) ? 2 : 1;
+    h.type = header[typePos];
+    if(h.flags & FRAME_WIDE_ID) {
+        h.type |= header[++typePos] << 8;
+    }
+    h.seq = header[typePos + 1];
+    if(h.flags & FRAME_LENGTH) {
+        h.length = header[size - 3] | (header[size - 2] << 8);
+    }
+    if((h.flags & FRAME_BATCH) && 
+       (h.type == 0 || h.type > std::numeric_limits<UnitType>::max())) {
+        return 0;
+    }
+    if(h.length == LENGTH_UNKNOWN) {
+        // only the objects know where the frame ends, 
+        // it has to be something we can decode
+        if((h.flags & ~supportedFrameFlags()) ||
+           (!(h.flags & FRAME_BATCH) && !TypeRegistry::isForeignTypeEnabled(h.type))) {
+            return 0;
+        }
+    }
+    return size;
 }
 
 inline void 
 Transport::deserialize(TypeBase*& d)
 {
     d = NULL;
-    UnitType fType = readObjectType();
-    // if we reached here then we have a sync!
-    assert(!isWaitSync());
-    d = buildObject(fType);
+    // hand out what is left from the last batch first
+    if(!mBatchObjects.empty()) {
+        d = mBatchObjects.front();
+        mBatchObjects.pop_front();
+        return;
+    }
+    if(mReadResetPending) {
+        mReadResetPending = false;
+        mReadSeqStarted = false;
+    }
+    FrameHeader h;
+    bool framed = false;
+    mFrameSequenced = false;
+    if(mCobs) {
+        framed = readCobsFrame(d);
+    } else if(readFrameHeader(h)) {
+        // if we reached here then we have a sync!
+        assert(!isWaitSync());
+        readFrame(h, d);
+        framed = true;
+    }
+    if(!mBatchObjects.empty()) {
+        d = mBatchObjects.front();
+        mBatchObjects.pop_front();
+    }
+    if(framed && d == NULL && !(mView && mView->isValid())) {
+        ++mDroppedFrames;
+        // deltas might have been applied before the frame turned 
+        // out to be broken
+        mReadDeltas.clear();
+    } else if(framed && mFrameSequenced) {
+        // only intact frames count, the number of a broken 
+        // one can't be trusted
+        accountSequence(mFrameSeq);
+    }
+    mReadChecksumOn = false;
     // waiting for the next object no matter the previous was successfull or not...
     setWaitSync();
 }
 
+inline void 
+Transport::deserialize(TypeBase*& d, ObjectView& view)
+{
+    view = ObjectView();
+    mView = &view;
+    deserialize(d);
+    mView = NULL;
+}
+
+inline void
+Transport::readFrame(const FrameHeader& h, TypeBase*& d)
+{
+    bool batch = h.flags & FRAME_BATCH;
+    bool varint = h.flags & FRAME_VARINT;
+    mFrameSequenced = h.flags & FRAME_SEQUENCE;
+    mFrameSeq = h.seq;
+    uint32_t length = h.length;
+    if(length == LENGTH_UNKNOWN && mReadBounded) {
+        // a COBS frame, all of it is buffered already
+        length = mReadEnd - mReadPos;
+    }
+    if(length == LENGTH_UNKNOWN || length > mReadBufferSize) {
+        bool known = batch || TypeRegistry::isForeignTypeEnabled(h.type);
+        if(h.length != LENGTH_UNKNOWN && 
+           (!known || (h.flags & ~supportedFrameFlags()))) {
+            skip(h.length);
+            return;
+        }
+        // decode while the frame streams in, the checksum 
+        // tells at the end whether to keep the objects
+        beginReadChecksum();
+        if(batch) {
+            buildBatch(h.type, h.flags);
+        } else {
+            d = buildObject(h.type, varint);
+        }
+        if(!endReadChecksum() || isWaitSync()) {
+            delete d;
+            d = NULL;
+            clearBatch();
+        }
+        return;
+    }
+    uint32_t checksumLength = checksumSize();
+    if(length < checksumLength || !readAhead(length)) {
+        return;
+    }
+    uint32_t frameEnd = mReadPos + length;
+    uint32_t payloadEnd = frameEnd - checksumLength;
+    if(h.flags & ~supportedFrameFlags()) {
+        mReadPos = frameEnd;
+        return;
+    }
+    // the whole frame is buffered, check it before anything is instantiated
+    uint32_t payloadPos = mReadPos;
+    beginReadChecksum();
+    mReadPos = payloadEnd;
+    bool valid = endReadChecksum();
+    mReadPos = payloadPos;
+    if(valid) {
+        // decode with the reads limited to the payload
+        uint32_t readEnd = mReadEnd;
+        bool bounded = mReadBounded;
+        mReadEnd = payloadEnd;
+        mReadBounded = true;
+        if(batch) {
+            buildBatch(h.type, h.flags);
+        } else if(!buildView(h.type, varint, payloadEnd)) {
+            d = buildObject(h.type, varint);
+        }
+        // the objects have to take exactly the payload
+        if(!isFunctional() || isWaitSync() || mReadPos != payloadEnd) {
+            delete d;
+            d = NULL;
+            clearBatch();
+        }
+        mReadBounded = bounded;
+        mReadEnd = readEnd;
+    }
+    // unknown, disabled or corrupted, the next frame starts here anyway
+    mReadPos = frameEnd;
+}
+
 inline TypeBase* 
-Transport::buildObject(UnitType fType)
+Transport::buildObject(IdType fType, bool varintFrame)
 {
-    mReadChecksum = 0;
     // construct the object
     TypeBase* d = TypeRegistry::instantiateForeignType(fType);
     // make sure the type was valid.. TBD: do a proper handling...
-    if(d == NULL) {
-        return NULL;
-    } else {
+    if(d != NULL) {
+        d->setArrivalTime(mFrameTime);
         // read the object
+        selectReadEncoding(varintFrame, d);
         d->read(*this);
-        // read the checksum
-        ChecksumType computedChecksum = mReadChecksum;
-        ChecksumType readChecksum;
-        read(readChecksum);
-        // and check the data 
-        if(readChecksum != computedChecksum) {
-            delete d;
-            return NULL;
-        }
     }
-    assert(d);
     return d;
 }
 
-inline Transport::ChecksumType
+inline bool
+Transport::buildView(IdType fType, bool varintFrame, uint32_t payloadEnd)
+{
+    IdType oType = TypeRegistry::foreignTypeToOwnType(fType);
+    // system and delta coded objects can't be read apart from the frame
+    if(mView == NULL || mViewReader == NULL || !TypeRegistry::isOwnTypeEnabled(oType) ||
+       TypeRegistry::isSystemType(oType) || TypeRegistry::isDeltaType(oType)) {
+        return false;
+    }
+    mView->mTransport = this;
+    mView->mBegin = mReadPos;
+    mView->mSize = payloadEnd - mReadPos;
+    mView->mId = oType;
+    mView->mVarint = varintFrame;
+    mView->mArrivalTime = mFrameTime;
+    mReadPos = payloadEnd;
+    return true;
+}
+
+inline void 
+Transport::buildBatch(UnitType count, UnitType flags)
+{
+    bool varintFrame = flags & FRAME_VARINT;
+    for(UnitType i = 0; i < count; ++i) {
+        IdType fType;
+        readTypeId(fType, flags & FRAME_WIDE_ID);
+        TypeBase* d = TypeRegistry::instantiateForeignType(fType);
+        if(d == NULL) {
+            // can't tell where the next object starts, drop the batch
+            clearBatch();
+            return;
+        }
+        d->setArrivalTime(mFrameTime);
+        selectReadEncoding(varintFrame, d);
+        d->read(*this);
+        mBatchObjects.push_back(d);
+        if(!isFunctional() || isWaitSync()) {
+            clearBatch();
+            return;
+        }
+    }
+}
+
+inline void
+Transport::writeTypeId(IdType t, bool wide)
+{
+    uint8_t id[2] = { (uint8_t)(t & 0xFF), (uint8_t)(t >> 8) };
+    write(id, wide ? 2 : 1);
+}
+
+inline void
+Transport::readTypeId(IdType& t, bool wide)
+{
+    uint8_t id[2] = { 0, 0 };
+    read(id, wide ? 2 : 1);
+    t = id[0] | (id[1] << 8);
+}
+
+inline void 
+Transport::clearBatch()
+{
+    TypeList::iterator dit = mBatchObjects.begin();
+    TypeList::iterator edit = mBatchObjects.end();
+    for(; dit != edit; ++dit) {
+        delete *dit;
+    }
+    mBatchObjects.clear();
+}
+
+inline Transport::UnitType
 Transport::calculateChecksumN(const void* ptr, uint32_t size)
 {
-    ChecksumType checksum = 0;
+    UnitType checksum = 0;
     uint8_t* bptr = (uint8_t*)ptr;
     for(uint32_t i = 0; i < size; ++i) {
         checksum += bptr[i];
@@ -163,37 +809,60 @@ Transport::calculateChecksumN(const void* ptr, uint32_t size)
     return checksum;
 }
 
-inline Transport::ChecksumType
-Transport::calculateChecksum8(const void* ptr)
+inline void
+Transport::beginWriteChecksum()
+{
+    mWriteChecksum = initialChecksum();
+    mWriteChecksumPos = mWriteSize;
+    mWriteChecksumOn = true;
+}
+
+inline void
+Transport::endWriteChecksum()
 {
-    uint8_t* bptr = (uint8_t*)ptr;
-    ChecksumType checksum = bptr[0];
-    return checksum;
+    updateWriteChecksum();
+    mWriteChecksumOn = false;
+    writeChecksum(mWriteChecksum);
 }
 
-inline Transport::ChecksumType
-Transport::calculateChecksum16(const void* ptr)
+inline void
+Transport::updateWriteChecksum()
 {
-    uint8_t* bptr = (uint8_t*)ptr;
-    ChecksumType checksum = bptr[0] + bptr[1];
-    return checksum;
+    // take in the bytes staged since the last update
+    if(mWriteChecksumOn) {
+        mWriteChecksum = calculateChecksum(mWriteChecksum, 
+                                           mWriteBuffer + mWriteChecksumPos, 
+                                           mWriteSize - mWriteChecksumPos);
+    }
+    mWriteChecksumPos = mWriteSize;
 }
 
-inline Transport::ChecksumType
-Transport::calculateChecksum32(const void* ptr)
+inline void
+Transport::beginReadChecksum()
 {
-    uint8_t* bptr = (uint8_t*)ptr;
-    ChecksumType checksum = bptr[0] + bptr[1] + bptr[2] + bptr[3];
-    return checksum;
+    mReadChecksum = initialChecksum();
+    mReadChecksumPos = mReadPos;
+    mReadChecksumOn = true;
 }
 
-inline Transport::ChecksumType
-Transport::calculateChecksum64(const void* ptr)
+inline bool
+Transport::endReadChecksum()
 {
-    uint8_t* bptr = (uint8_t*)ptr;
-    ChecksumType checksum = bptr[0] + bptr[1] + bptr[2] + bptr[3] + 
-                            bptr[4] + bptr[5] + bptr[6] + bptr[7];
-    return checksum;
+    updateReadChecksum();
+    mReadChecksumOn = false;
+    return readChecksum(mReadChecksum);
+}
+
+inline void
+Transport::updateReadChecksum()
+{
+    // take in the bytes consumed since the last update
+    if(mReadChecksumOn) {
+        mReadChecksum = calculateChecksum(mReadChecksum, 
+                                          mReadBuffer + mReadChecksumPos, 
+                                          mReadPos - mReadChecksumPos);
+    }
+    mReadChecksumPos = mReadPos;
 }
 
 ////////////////////////////////////////////////////////
@@ -202,63 +871,49 @@ Transport::calculateChecksum64(const void* ptr)
 inline void
 Transport::write(uint64_t intd)
 {
-    fixEndianness64(&intd);
-    write(&intd, sizeof(uint64_t));
-    mWriteChecksum += calculateChecksum64(&intd);
+    writeInteger64(intd, false);
 }
 
 inline void
 Transport::write(int64_t intd)
 {
-    fixEndianness64(&intd);
-    write(&intd, sizeof(int64_t));
-    mWriteChecksum += calculateChecksum64(&intd);
+    writeInteger64(intd, true);
 }
 
 inline void
 Transport::write(uint32_t intd)
 {
-    fixEndianness32(&intd);
-    write(&intd, sizeof(uint32_t));
-    mWriteChecksum += calculateChecksum32(&intd);
+    writeInteger32(intd, false);
 }
 
 inline void
 Transport::write(int32_t intd)
 {
-    fixEndianness32(&intd);
-    write(&intd, sizeof(int32_t));
-    mWriteChecksum += calculateChecksum32(&intd);
+    writeInteger32(intd, true);
 }
 
 inline void
 Transport::write(uint16_t intd)
 {
-    fixEndianness16(&intd);
-    write(&intd, sizeof(uint16_t));
-    mWriteChecksum += calculateChecksum16(&intd);
+    writeInteger16(intd, false);
 }
 
 inline void
 Transport::write(int16_t intd)
 {
-    fixEndianness16(&intd);
-    write(&intd, sizeof(int16_t));
-    mWriteChecksum += calculateChecksum16(&intd);
+    writeInteger16(intd, true);
 }
 
 inline void
 Transport::write(uint8_t intd)
 {
     write(&intd, sizeof(uint8_t));
-    mWriteChecksum += calculateChecksum8(&intd);
 }
 
 inline void
 Transport::write(int8_t intd)
 {
     write(&intd, sizeof(int8_t));
-    mWriteChecksum += calculateChecksum8(&intd);
 }
 
 
@@ -267,7 +922,6 @@ Transport::write(float floatd)
 {
     fixEndianness32(&floatd);
     write(&floatd, sizeof(float));
-    mWriteChecksum += calculateChecksum32(&floatd);
 }
 
 inline void
@@ -275,7 +929,6 @@ Transport::write(double doubled)
 {
     fixEndianness64(&doubled);
     write(&doubled, sizeof(double));
-    mWriteChecksum += calculateChecksum64(&doubled);
 }
 
 inline void
@@ -284,7 +937,6 @@ Transport::write(const std::string& stringd)
     uint32_t stringd_len = stringd.length();
     writeChecksumed(stringd_len);
     write(stringd.c_str(), stringd_len);
-    mWriteChecksum += calculateChecksumN(stringd.c_str(), stringd_len);
 }
 
 
@@ -294,71 +946,62 @@ Transport::write(const std::string& stringd)
 inline void
 Transport::read(uint64_t& intd)
 {
-    read(&intd, sizeof(uint64_t));
-    mReadChecksum += calculateChecksum64(&intd);
-    fixEndianness64(&intd);
+    readInteger64(intd, false);
 }
 
 inline void
 Transport::read(int64_t& intd)
 {
-    read(&intd, sizeof(int64_t));
-    mReadChecksum += calculateChecksum64(&intd);
-    fixEndianness64(&intd);
+    uint64_t v;
+    readInteger64(v, true);
+    intd = v;
 }
 
 inline void
 Transport::read(uint32_t& intd)
 {
-    read(&intd, sizeof(uint32_t));
-    mReadChecksum += calculateChecksum32(&intd);
-    fixEndianness32(&intd);
+    readInteger32(intd, false);
 }
 
 inline void
 Transport::read(int32_t& intd)
 {
-    read(&intd, sizeof(int32_t));
-    mReadChecksum += calculateChecksum32(&intd);
-    fixEndianness32(&intd);
+    uint32_t v;
+    readInteger32(v, true);
+    intd = v;
 }
 
 
 inline void
 Transport::read(uint16_t& intd)
 {
-    read(&intd, sizeof(uint16_t));
-    mReadChecksum += calculateChecksum16(&intd);
-    fixEndianness16(&intd);
+    readInteger16(intd, false);
 }
 
 inline void
 Transport::read(int16_t& intd)
 {
-    read(&intd, sizeof(int16_t));
-    mReadChecksum += calculateChecksum16(&intd);
-    fixEndianness16(&intd);
+    uint16_t v;
+    readInteger16(v, true);
+    intd = v;
 }
 
 inline void
 Transport::read(uint8_t& intd)
 {
     read(&intd, sizeof(uint8_t));
-    mReadChecksum += calculateChecksum8(&intd);
 }
 
 inline void
 Transport::read(int8_t& intd)
 {
     read(&intd, sizeof(int8_t));
-    mReadChecksum += calculateChecksum8(&intd);
 }
 
 inline void
 Transport::read(float& floatd)
 {
     read(&floatd, sizeof(float));
-    mReadChecksum += calculateChecksum32(&floatd);
     fixEndianness32(&floatd);
 }
 
@@ -366,23 +1009,60 @@ inline void
 Transport::read(double& doubled)
 {
     read(&doubled, sizeof(double));
-    mReadChecksum += calculateChecksum64(&doubled);
     fixEndianness64(&doubled);
 }
 
 inline void
 Transport::read(std::string& stringd)
 {
-    uint32_t stringd_len;
-    readChecksumed(stringd_len);
+    uint32_t stringd_len = readStringLength();
     if(isWaitSync()) {
         return;
     }
-    char* buf = new char[stringd_len];
-    read(buf, stringd_len);
-    mReadChecksum += calculateChecksumN(buf, stringd_len);
-    stringd.assign(buf, stringd_len);
-    delete buf;
+    // decode straight from the read buffer, the string 
+    // allocates only if its capacity is not enough
+    stringd.erase();
+    stringd.reserve(stringd_len);
+    while(stringd_len) {
+        if(mReadPos == mReadEnd && !fill()) {
+            return;
+        }
+        uint32_t chunk = std::min(stringd_len, mReadEnd - mReadPos);
+        stringd.append((const char*)mReadBuffer + mReadPos, chunk);
+        mReadPos += chunk;
+        stringd_len -= chunk;
+    }
+}
+
+inline bool
+Transport::readView(const char*& str, uint32_t& len)
+{
+    len = readStringLength();
+    if(isWaitSync()) {
+        return false;
+    }
+    if(!readAhead(len)) {
+        // the length is consumed but the string can't be, it is 
+        // longer than the buffer or the frame: the frame is broken
+        if(isFunctional()) {
+            setWaitSync();
+        }
+        return false;
+    }
+    str = (const char*)mReadBuffer + mReadPos;
+    mReadPos += len;
+    return true;
+}
+
+inline uint32_t
+Transport::readStringLength()
+{
+    uint32_t stringd_len;
+    readChecksumed(stringd_len);
+    if(stringd_len > mMaxStringLength) {
+        setWaitSync();
+    }
+    return stringd_len;
 }
 
 
@@ -391,20 +1071,12 @@ template <class T>
 void
 Transport::readChecksumed(T& data) 
 {
-    // save the current checksum
-    ChecksumType curChecksum = mReadChecksum;
-    // reset it
-    mReadChecksum = 0;
-    // read the data
+    // read the data and its own checksum, the frame checksum covers both
     read(data);
-    // read and get the calculated chechsums
-    ChecksumType computedChecksum = mReadChecksum;
-    ChecksumType readChecksum;
+    UnitType readChecksum;
     read(readChecksum);
-    // restore the saved checksum
-    mReadChecksum += curChecksum;
     // check the checksum and change the device state if needed 
-    if(readChecksum != computedChecksum) {
+    if(readChecksum != calculateChecksumN(&data, sizeof(T))) {
         setWaitSync();
     }
 }
@@ -413,34 +1085,267 @@ template <class T>
 void
 Transport::writeChecksumed(const T& data) 
 {
-    // save the current checksum
-    ChecksumType curChecksum = mWriteChecksum;
-    // reset it
-    mWriteChecksum = 0;
-    // write the data
+    // the value gets a checksum of its own so that the reader can 
+    // trust it before the whole frame is in
     write(data);
-    // write the checksum
-    write(mWriteChecksum);
-    // restore the saved checksum
-    mWriteChecksum += curChecksum;
+    write(calculateChecksumN(&data, sizeof(T)));
 }
 
 
 ////////////////////////////////////////////////////////
-// Endianness                                         //
+// Arrays                                             //
 ////////////////////////////////////////////////////////
-template <ConfigEndianness E, int L> 
 inline void
-Transport::fixEndianness(void*)
+Transport::writeArray(const uint64_t* ptr, uint32_t n)
 {
+    if(mWriteVarint) {
+        for(uint32_t i = 0; i < n; ++i) {
+            write(ptr[i]);
+        }
+    } else {
+        writeArray64(ptr, n);
+    }
 }
 
-template <> 
 inline void
-Transport::fixEndianness<ENDIAN_SWAP, 2>(void* ptr)
+Transport::writeArray(const int64_t* ptr, uint32_t n)
 {
-    uint16_t& v = *(uint16_t*)ptr;
-    v = (v>>8) | 
+    if(mWriteVarint) {
+        for(uint32_t i = 0; i < n; ++i) {
+            write(ptr[i]);
+        }
+    } else {
+        writeArray64(ptr, n);
+    }
+}
+
+inline void
+Transport::writeArray(const uint32_t* ptr, uint32_t n)
+{
+    if(mWriteVarint) {
+        for(uint32_t i = 0; i < n; ++i) {
+            write(ptr[i]);
+        }
+    } else {
+        writeArray32(ptr, n);
+    }
+}
+
+inline void
+Transport::writeArray(const int32_t* ptr, uint32_t n)
+{
+    if(mWriteVarint) {
+        for(uint32_t i = 0; i < n; ++i) {
+            write(ptr[i]);
+        }
+    } else {
+        writeArray32(ptr, n);
+    }
+}
+
+inline void
+Transport::writeArray(const uint16_t* ptr, uint32_t n)
+{
+    if(mWriteVarint) {
+        for(uint32_t i = 0; i < n; ++i) {
+            write(ptr[i]);
+        }
+    } else {
+        writeArray16(ptr, n);
+    }
+}
+
+inline void
+Transport::writeArray(const int16_t* ptr, uint32_t n)
+{
+    if(mWriteVarint) {
+        for(uint32_t i = 0; i < n; ++i) {
+            write(ptr[i]);
+        }
+    } else {
+        writeArray16(ptr, n);
+    }
+}
+
+inline void
+Transport::writeArray(const uint8_t* ptr, uint32_t n)
+{
+    write((const void*)ptr, n);
+}
+
+inline void
+Transport::writeArray(const int8_t* ptr, uint32_t n)
+{
+    write((const void*)ptr, n);
+}
+
+inline void
+Transport::writeArray(const float* ptr, uint32_t n)
+{
+    writeArray32(ptr, n);
+}
+
+inline void
+Transport::writeArray(const double* ptr, uint32_t n)
+{
+    writeArray64(ptr, n);
+}
+
+inline void
+Transport::readArray(uint64_t* ptr, uint32_t n)
+{
+    if(mReadVarint) {
+        for(uint32_t i = 0; i < n; ++i) {
+            read(ptr[i]);
+        }
+    } else {
+        readArray64(ptr, n);
+    }
+}
+
+inline void
+Transport::readArray(int64_t* ptr, uint32_t n)
+{
+    if(mReadVarint) {
+        for(uint32_t i = 0; i < n; ++i) {
+            read(ptr[i]);
+        }
+    } else {
+        readArray64(ptr, n);
+    }
+}
+
+inline void
+Transport::readArray(uint32_t* ptr, uint32_t n)
+{
+    if(mReadVarint) {
+        for(uint32_t i = 0; i < n; ++i) {
+            read(ptr[i]);
+        }
+    } else {
+        readArray32(ptr, n);
+    }
+}
+
+inline void
+Transport::readArray(int32_t* ptr, uint32_t n)
+{
+    if(mReadVarint) {
+        for(uint32_t i = 0; i < n; ++i) {
+            read(ptr[i]);
+        }
+    } else {
+        readArray32(ptr, n);
+    }
+}
+
+inline void
+Transport::readArray(uint16_t* ptr, uint32_t n)
+{
+    if(mReadVarint) {
+        for(uint32_t i = 0; i < n; ++i) {
+            read(ptr[i]);
+        }
+    } else {
+        readArray16(ptr, n);
+    }
+}
+
+inline void
+Transport::readArray(int16_t* ptr, uint32_t n)
+{
+    if(mReadVarint) {
+        for(uint32_t i = 0; i < n; ++i) {
+            read(ptr[i]);
+        }
+    } else {
+        readArray16(ptr, n);
+    }
+}
+
+inline void
+Transport::readArray(uint8_t* ptr, uint32_t n)
+{
+    read((void*)ptr, n);
+}
+
+inline void
+Transport::readArray(int8_t* ptr, uint32_t n)
+{
+    read((void*)ptr, n);
+}
+
+inline void
+Transport::readArray(float* ptr, uint32_t n)
+{
+    readArray32(ptr, n);
+}
+
+inline void
+Transport::readArray(double* ptr, uint32_t n)
+{
+    readArray64(ptr, n);
+}
+
+////////////////////////////////////////////////////////
+// Varints (LEB128)                                   //
+////////////////////////////////////////////////////////
+inline void
+Transport::writeVarint(uint64_t v)
+{
+    uint8_t buf[10];
+    uint32_t size = 0;
+    while(v >= 0x80) {
+        buf[size++] = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    buf[size++] = (uint8_t)v;
+    write(buf, size);
+}
+
+inline bool
+Transport::readVarint(uint64_t& v, uint32_t maxSize)
+{
+    v = 0;
+    if(mReadEnd - mReadPos >= maxSize) {
+        // enough data buffered, decode in place
+        const uint8_t* bptr = mReadBuffer + mReadPos;
+        for(uint32_t i = 0; i < maxSize; ++i) {
+            v |= (uint64_t)(bptr[i] & 0x7F) << (7*i);
+            if(!(bptr[i] & 0x80)) {
+                mReadPos += i + 1;
+                return true;
+            }
+        }
+        mReadPos += maxSize;
+        return false;
+    }
+    for(uint32_t i = 0; i < maxSize; ++i) {
+        uint8_t b = 0;
+        read(&b, 1);
+        v |= (uint64_t)(b & 0x7F) << (7*i);
+        if(!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+////////////////////////////////////////////////////////
+// Endianness                                         //
+////////////////////////////////////////////////////////
+template <ConfigEndianness E, int L> 
+inline void
+Transport::fixEndianness(void*)
+{
+}
+
+template <> 
+inline void
+Transport::fixEndianness<ENDIAN_SWAP, 2>(void* ptr)
+{
+    uint16_t& v = *(uint16_t*)ptr;
+    v = (v>>8) | 
         (v<<8);
 }
 
@@ -476,12 +1381,479 @@ Transport::swap(Transport& transport)
     std::swap(mState, transport.mState);
     std::swap(mWriteChecksum, transport.mWriteChecksum);
     std::swap(mReadChecksum, transport.mReadChecksum);
+    std::swap(mWriteSize, transport.mWriteSize);
+    std::swap(mReadPos, transport.mReadPos);
+    std::swap(mReadEnd, transport.mReadEnd);
+    std::swap(mWriteChecksumPos, transport.mWriteChecksumPos);
+    std::swap(mReadChecksumPos, transport.mReadChecksumPos);
+    std::swap(mWriteChecksumOn, transport.mWriteChecksumOn);
+    std::swap(mReadChecksumOn, transport.mReadChecksumOn);
+    std::swap(mLinkOptions, transport.mLinkOptions);
+    std::swap(mWriteVarint, transport.mWriteVarint);
+    std::swap(mReadVarint, transport.mReadVarint);
+    std::swap(mWriteDelta, transport.mWriteDelta);
+    std::swap(mReadDelta, transport.mReadDelta);
+    std::swap(mWriteResetPending, transport.mWriteResetPending);
+    std::swap(mReadResetPending, transport.mReadResetPending);
+    mWriteDeltas.swap(transport.mWriteDeltas);
+    mReadDeltas.swap(transport.mReadDeltas);
+    std::swap(mFrameHeaderPos, transport.mFrameHeaderPos);
+    std::swap(mFrameHeaderSize, transport.mFrameHeaderSize);
+    std::swap(mFrameLengthPending, transport.mFrameLengthPending);
+    std::swap(mWritesHeld, transport.mWritesHeld);
+    std::swap(mDiscardedBytes, transport.mDiscardedBytes);
+    std::swap(mDroppedFrames, transport.mDroppedFrames);
+    std::swap(mWriteSeq, transport.mWriteSeq);
+    std::swap(mReadSeq, transport.mReadSeq);
+    std::swap(mReadSeqWindow, transport.mReadSeqWindow);
+    std::swap(mReadSeqLost, transport.mReadSeqLost);
+    std::swap(mReadSeqStarted, transport.mReadSeqStarted);
+    std::swap(mReceivedFrames, transport.mReceivedFrames);
+    std::swap(mLostFrames, transport.mLostFrames);
+    std::swap(mDuplicatedFrames, transport.mDuplicatedFrames);
+    std::swap(mReorderedFrames, transport.mReorderedFrames);
+    std::swap(mClock, transport.mClock);
+    std::swap(mCobsSize, transport.mCobsSize);
+    std::swap(mCobsCodePos, transport.mCobsCodePos);
+    mBatchObjects.swap(transport.mBatchObjects);
+}
+
+////////////////////////////////////////////////////////
+// Write buffering                                    //
+////////////////////////////////////////////////////////
+inline void
+Transport::write(const void* ptr, uint32_t size)
+{
+    if(mWriteSize + size > mWriteBufferSize) {
+        if(size > mWriteBufferSize) {
+            // the chunk is bigger than the whole buffer, there is no 
+            // point in staging it, it goes right after the staged bytes
+            flush(ptr, size);
+            return;
+        }
+        // no room left, send out what we have so far
+        flush();
+        if(mWriteSize + size > mWriteBufferSize) {
+            // the open frame alone still leaves no room
+            flush();
+        }
+    }
+    memcpy(mWriteBuffer + mWriteSize, ptr, size);
+    mWriteSize += size;
+}
+
+inline void
+Transport::flush()
+{
+    flush(NULL, 0);
+}
+
+inline void
+Transport::flush(const void* ptr, uint32_t size)
+{
+    updateWriteChecksum();
+    if(size == 0 && mFrameHeaderPos) {
+        // the held frames go out alone, the open one moves to the 
+        // front so that its length can still be filled in
+        deviceWrite(mWriteBuffer, mFrameHeaderPos);
+        mWriteSize -= mFrameHeaderPos;
+        memmove(mWriteBuffer, mWriteBuffer + mFrameHeaderPos, mWriteSize);
+        mFrameHeaderPos = 0;
+        mWriteChecksumPos = mWriteSize;
+        return;
+    }
+    mWriteChecksumPos = 0;
+    if(mWriteChecksumOn && size) {
+        mWriteChecksum = calculateChecksum(mWriteChecksum, ptr, size);
+    }
+    // the header is gone, the frame goes out without its length,
+    // whatever was held before it goes out as well
+    mFrameHeaderPos = 0;
+    mFrameLengthPending = false;
+    if(mCobs) {
+        cobsEncode(mWriteBuffer, mWriteSize);
+        cobsEncode(ptr, size);
+    } else if(mWriteSize && size) {
+        IoChunk chunks[2] = { { mWriteBuffer, mWriteSize }, { ptr, size } };
+        deviceWrite(chunks, 2);
+    } else if(mWriteSize || size) {
+        deviceWrite(mWriteSize ? mWriteBuffer : ptr, mWriteSize + size);
+    }
+    mWriteSize = 0;
+}
+
+template <int L>
+void
+Transport::writeSwapped(const void* ptr, uint32_t n)
+{
+    const uint8_t* bptr = (const uint8_t*)ptr;
+    while(n) {
+        uint32_t room = (mWriteBufferSize - mWriteSize) / L;
+        if(room == 0) {
+            flush();
+            room = (mWriteBufferSize - mWriteSize) / L;
+        }
+        // swap straight into the staging buffer
+        uint32_t chunk = std::min(n, room);
+        ByteSwap<L>::copy(mWriteBuffer + mWriteSize, bptr, chunk);
+        mWriteSize += chunk * L;
+        bptr += chunk * L;
+        n -= chunk;
+    }
+}
+
+////////////////////////////////////////////////////////
+// Read buffering                                     //
+////////////////////////////////////////////////////////
+inline void
+Transport::read(void* ptr, uint32_t size) 
+{
+    uint8_t* bptr = (uint8_t*)ptr;
+    while(size) {
+        uint32_t available = mReadEnd - mReadPos;
+        if(available == 0) {
+            if(mReadBounded) {
+                // the object wants more than its frame has
+                setWaitSync();
+                return;
+            }
+            if(size >= mReadBufferSize) {
+                // nothing is buffered and the chunk wouldn't fit 
+                // anyway, read it directly
+                updateReadChecksum();
+                uint32_t bytesRead = deviceRead(bptr, size);
+                if(bytesRead == 0) {
+                    return;
+                }
+                if(mReadChecksumOn) {
+                    mReadChecksum = calculateChecksum(mReadChecksum, bptr, bytesRead);
+                }
+                bptr += bytesRead;
+                size -= bytesRead;
+                continue;
+            }
+            if(!fill()) {
+                return;
+            }
+            available = mReadEnd;
+        }
+        uint32_t chunk = std::min(size, available);
+        memcpy(bptr, mReadBuffer + mReadPos, chunk);
+        mReadPos += chunk;
+        bptr += chunk;
+        size -= chunk;
+    }
+}
+
+template <int L>
+void
+Transport::readSwapped(void* ptr, uint32_t n)
+{
+    uint8_t* bptr = (uint8_t*)ptr;
+    while(n && isFunctional()) {
+        uint32_t available = (mReadEnd - mReadPos) / L;
+        if(available == 0) {
+            // the element is split over the buffer end, take it alone
+            read(bptr, L);
+            fixEndianness<ENDIAN_SWAP,L>(bptr);
+            bptr += L;
+            --n;
+            continue;
+        }
+        uint32_t chunk = std::min(n, available);
+        ByteSwap<L>::copy(bptr, mReadBuffer + mReadPos, chunk);
+        mReadPos += chunk * L;
+        bptr += chunk * L;
+        n -= chunk;
+    }
+}
+
+inline bool
+Transport::readAhead(uint32_t size)
+{
+    if(mReadBounded) {
+        return mReadEnd - mReadPos >= size;
+    }
+    if(size > mReadBufferSize) {
+        return false;
+    }
+    if(mReadPos + size > mReadBufferSize) {
+        // move the unread bytes to the front to make room
+        updateReadChecksum();
+        mReadEnd -= mReadPos;
+        memmove(mReadBuffer, mReadBuffer + mReadPos, mReadEnd);
+        mReadPos = 0;
+        mReadChecksumPos = 0;
+    }
+    while(mReadEnd - mReadPos < size) {
+        uint32_t bytesRead = deviceRead(mReadBuffer + mReadEnd, mReadBufferSize - mReadEnd);
+        if(bytesRead == 0) {
+            return false;
+        }
+        mReadEnd += bytesRead;
+    }
+    return true;
+}
+
+inline void
+Transport::skip(uint32_t size)
+{
+    while(size) {
+        if(mReadPos == mReadEnd && !fill()) {
+            return;
+        }
+        uint32_t chunk = std::min(size, mReadEnd - mReadPos);
+        mReadPos += chunk;
+        size -= chunk;
+    }
+}
+
+inline bool
+Transport::fill()
+{
+    if(mReadBounded) {
+        setWaitSync();
+        return false;
+    }
+    // the buffer is drained at this point, take as much as the device has
+    updateReadChecksum();
+    mReadChecksumPos = 0;
+    mReadPos = 0;
+    mReadEnd = deviceRead(mReadBuffer, mReadBufferSize);
+    return mReadEnd != 0;
+}
+
+////////////////////////////////////////////////////////
+// COBS framing                                       //
+////////////////////////////////////////////////////////
+inline void
+Transport::cobsEncode(const void* ptr, uint32_t size)
+{
+    const uint8_t* bptr = (const uint8_t*)ptr;
+    while(size) {
+        // a block takes at most 254 bytes up to the next zero
+        uint32_t room = 0xFF - (mCobsSize - mCobsCodePos);
+        uint32_t span = std::min(size, room);
+        const uint8_t* zero = (const uint8_t*)memchr(bptr, 0, span);
+        if(zero) {
+            span = zero - bptr;
+        }
+        if(mCobsSize + span + 1 > mCobsBufferSize) {
+            cobsFlush();
+        }
+        memcpy(mCobsBuffer + mCobsSize, bptr, span);
+        mCobsSize += span;
+        bptr += span;
+        size -= span;
+        if(zero || span == room) {
+            // close the block, the zero is implied by its code
+            mCobsBuffer[mCobsCodePos] = mCobsSize - mCobsCodePos;
+            mCobsCodePos = mCobsSize++;
+            if(zero) {
+                ++bptr;
+                --size;
+            }
+        }
+    }
+}
+
+inline void
+Transport::cobsFlush()
+{
+    // send the closed blocks, the open one waits for its code
+    deviceWrite(mCobsBuffer, mCobsCodePos);
+    mCobsSize -= mCobsCodePos;
+    memmove(mCobsBuffer, mCobsBuffer + mCobsCodePos, mCobsSize);
+    mCobsCodePos = 0;
+}
+
+inline void
+Transport::cobsEndFrame()
+{
+    if(mCobsSize == mCobsBufferSize) {
+        cobsFlush();
+    }
+    mCobsBuffer[mCobsCodePos] = mCobsSize - mCobsCodePos;
+    mCobsBuffer[mCobsSize++] = 0;
+    if(mWritesHeld && mCobsSize < mCobsBufferSize) {
+        // the frame waits behind the ones before it, the 
+        // next one starts with a code byte
+        mCobsCodePos = mCobsSize++;
+        return;
+    }
+    deviceWrite(mCobsBuffer, mCobsSize);
+    // the next frame starts with a code byte
+    mCobsSize = 1;
+    mCobsCodePos = 0;
+}
+
+inline bool
+Transport::readCobsFrame(TypeBase*& d)
+{
+    // the whole frame up to its zero has to be buffered, 
+    // it arrives with its first byte
+    uint32_t end;
+    bool stamped = false;
+    while(true) {
+        if(!stamped && mReadPos != mReadEnd) {
+            mFrameTime = mClock ? mClock() : 0;
+            stamped = true;
+        }
+        const uint8_t* zero = (const uint8_t*)memchr(mReadBuffer + mReadPos, 0, 
+                                                     mReadEnd - mReadPos);
+        if(zero) {
+            end = zero - mReadBuffer;
+            break;
+        }
+        uint32_t available = mReadEnd - mReadPos;
+        if(available == mReadBufferSize) {
+            // too long, the rest of it will fail to decode
+            mDiscardedBytes += available;
+            mReadPos = mReadEnd;
+            available = 0;
+        }
+        if(!readAhead(available + 1)) {
+            return false;
+        }
+    }
+    uint32_t readEnd = mReadEnd;
+    uint32_t size = cobsDecode(mReadBuffer + mReadPos, end - mReadPos);
+    if(size) {
+        // decode the frame as usual, with the reads limited to it
+        mReadEnd = mReadPos + size;
+        mReadBounded = true;
+        FrameHeader h;
+        uint32_t headerSize = parseFrameHeader(h);
+        if(headerSize) {
+            mReadPos += headerSize;
+            setFunctional();
+            readFrame(h, d);
+        }
+        mReadBounded = false;
+        mReadEnd = readEnd;
+    }
+    mReadPos = end + 1;
+    return true;
+}
+
+inline uint32_t
+Transport::cobsDecode(uint8_t* ptr, uint32_t size)
+{
+    // the decoded frame is never longer, it is written over the encoded one
+    uint32_t in = 0;
+    uint32_t out = 0;
+    while(in < size) {
+        uint32_t code = ptr[in++];
+        if(code == 0 || in + code - 1 > size) {
+            return 0;
+        }
+        memmove(ptr + out, ptr + in, code - 1);
+        in += code - 1;
+        out += code - 1;
+        if(code != 0xFF && in < size) {
+            ptr[out++] = 0;
+        }
+    }
+    return out;
+}
+
+////////////////////////////////////////////////////////
+// Object views                                       //
+////////////////////////////////////////////////////////
+inline
+ObjectView::ObjectView()
+ : mTransport(NULL),
+   mBegin(0),
+   mSize(0),
+   mId(0),
+   mVarint(false),
+   mArrivalTime(0)
+{}
+
+inline bool
+ObjectView::isValid() const
+{
+    return mTransport != NULL;
+}
+
+inline ObjectView::IdType
+ObjectView::id() const
+{
+    return mId;
+}
+
+inline uint64_t
+ObjectView::arrivalTime() const
+{
+    return mArrivalTime;
+}
+
+inline const uint8_t*
+ObjectView::data() const
+{
+    return mTransport->mReadBuffer + mBegin;
+}
+
+inline uint32_t
+ObjectView::size() const
+{
+    return mSize;
+}
+
+inline bool
+ObjectView::isVarint() const
+{
+    return mVarint;
+}
+
+inline Transport&
+ObjectView::reader(uint32_t offset) const
+{
+    Transport& t = *mTransport->mViewReader;
+    t.mReadBuffer = mTransport->mReadBuffer;
+    t.mReadBufferSize = mTransport->mReadBufferSize;
+    // reads past the object fail as they do past a frame
+    t.mReadPos = mBegin + std::min(offset, mSize);
+    t.mReadEnd = mBegin + mSize;
+    t.mReadBounded = true;
+    t.mReadVarint = mVarint;
+    t.mReadDelta = false;
+    t.setFunctional();
+    return t;
+}
+
+inline TypeBase*
+ObjectView::instantiate() const
+{
+    TypeBase* d = TypeRegistry::instantiateOwnType(mId);
+    if(d == NULL) {
+        return NULL;
+    }
+    d->setArrivalTime(mArrivalTime);
+    Transport& t = reader();
+    d->read(t);
+    // same as for the objects built from frames
+    bool valid = t.isFunctional() && t.mReadPos == mBegin + mSize;
+    if(!valid) {
+        delete d;
+        d = NULL;
+    }
+    return d;
 }
 
 template <typename C, typename D>
 ConfiguredTransport<C,D>::ConfiguredTransport(D* device)
- : mDevice(device)
+ : Transport(mWriteStorage, C::WriteBufferSize,
+             mReadStorage,  C::ReadBufferSize),
+   mDevice(device)
 {
+    mFixedCodec = (C::Endianness == ENDIAN_SWAP) ? CODEC_SWAP : CODEC_NATIVE;
+    mMaxStringLength = C::MaxStringLength;
+    mDeltaKeyInterval = C::DeltaKeyInterval;
+    mCobs = (C::Framing == FRAMING_COBS);
+    mCobsBuffer = mCobsStorage;
+    mCobsBufferSize = sizeof(mCobsStorage);
+    mViewReader = ViewReader<C>::get(mViewReaderStorage);
 }
 
 template <typename C, typename D>
@@ -505,6 +1877,163 @@ ConfiguredTransport<C,D>::fixEndianness64(void* ptr)
     fixEndianness<C::Endianness,8>(ptr);
 }
 
+template <typename C, typename D>
+void 
+ConfiguredTransport<C,D>::writeArray16(const void* ptr, uint32_t n)
+{
+    writeFixedArray<2>(ptr, n);
+}
+
+template <typename C, typename D>
+void 
+ConfiguredTransport<C,D>::writeArray32(const void* ptr, uint32_t n)
+{
+    writeFixedArray<4>(ptr, n);
+}
+
+template <typename C, typename D>
+void 
+ConfiguredTransport<C,D>::writeArray64(const void* ptr, uint32_t n)
+{
+    writeFixedArray<8>(ptr, n);
+}
+
+template <typename C, typename D>
+void 
+ConfiguredTransport<C,D>::readArray16(void* ptr, uint32_t n)
+{
+    readFixedArray<2>(ptr, n);
+}
+
+template <typename C, typename D>
+void 
+ConfiguredTransport<C,D>::readArray32(void* ptr, uint32_t n)
+{
+    readFixedArray<4>(ptr, n);
+}
+
+template <typename C, typename D>
+void 
+ConfiguredTransport<C,D>::readArray64(void* ptr, uint32_t n)
+{
+    readFixedArray<8>(ptr, n);
+}
+
+template <typename C, typename D>
+template <int L>
+void 
+ConfiguredTransport<C,D>::writeFixedArray(const void* ptr, uint32_t n)
+{
+    if(C::Endianness == ENDIAN_SWAP) {
+        writeSwapped<L>(ptr, n);
+    } else {
+        Transport::write(ptr, n * L);
+    }
+}
+
+template <typename C, typename D>
+template <int L>
+void 
+ConfiguredTransport<C,D>::readFixedArray(void* ptr, uint32_t n)
+{
+    if(C::Endianness == ENDIAN_SWAP) {
+        readSwapped<L>(ptr, n);
+    } else {
+        Transport::read(ptr, n * L);
+    }
+}
+
+template <typename C, typename D>
+void 
+ConfiguredTransport<C,D>::writeInteger16(uint16_t v, bool isSigned)
+{
+    writeInteger(v, isSigned);
+}
+
+template <typename C, typename D>
+void 
+ConfiguredTransport<C,D>::writeInteger32(uint32_t v, bool isSigned)
+{
+    writeInteger(v, isSigned);
+}
+
+template <typename C, typename D>
+void 
+ConfiguredTransport<C,D>::writeInteger64(uint64_t v, bool isSigned)
+{
+    writeInteger(v, isSigned);
+}
+
+template <typename C, typename D>
+void 
+ConfiguredTransport<C,D>::readInteger16(uint16_t& v, bool isSigned)
+{
+    readInteger(v, isSigned);
+}
+
+template <typename C, typename D>
+void 
+ConfiguredTransport<C,D>::readInteger32(uint32_t& v, bool isSigned)
+{
+    readInteger(v, isSigned);
+}
+
+template <typename C, typename D>
+void 
+ConfiguredTransport<C,D>::readInteger64(uint64_t& v, bool isSigned)
+{
+    readInteger(v, isSigned);
+}
+
+template <typename C, typename D>
+template <typename T>
+void 
+ConfiguredTransport<C,D>::writeInteger(T v, bool isSigned)
+{
+    // the varint branch is compiled out for ENCODING_FIXED
+    if(C::Encoding == ENCODING_VARINT && mWriteVarint) {
+        if(isSigned) {
+            // zigzag, small negative numbers get small codes too
+            T sign = (v >> (sizeof(T)*8 - 1)) ? ~(T)0 : 0;
+            v = (T)(v << 1) ^ sign;
+        }
+        writeVarint(v);
+    } else {
+        fixEndianness<C::Endianness,sizeof(T)>(&v);
+        Transport::write(&v, sizeof(T));
+    }
+}
+
+template <typename C, typename D>
+template <typename T>
+void 
+ConfiguredTransport<C,D>::readInteger(T& v, bool isSigned)
+{
+    if(C::Encoding == ENCODING_VARINT && mReadVarint) {
+        uint64_t value;
+        if(!readVarint(value, (sizeof(T)*8 + 6) / 7)) {
+            // too long for the type, the frame is broken
+            setWaitSync();
+        }
+        v = (T)value;
+        if(isSigned) {
+            v = (T)(v >> 1) ^ (T)(0 - (v & 1));
+        }
+    } else {
+        Transport::read(&v, sizeof(T));
+        fixEndianness<C::Endianness,sizeof(T)>(&v);
+    }
+}
+
+template <typename C, typename D>
+uint32_t
+ConfiguredTransport<C,D>::supportedLinkOptions() const
+{
+    return LINK_LENGTH | LINK_WIDE_ID | 
+           ((C::Encoding == ENCODING_VARINT) ? LINK_VARINT : 0) | 
+           ((C::Sequencing == SEQUENCING_ENABLED) ? LINK_SEQUENCE : 0);
+}
+
 template <typename C, typename D>
 void
 ConfiguredTransport<C,D>::start()
@@ -529,15 +2058,66 @@ ConfiguredTransport<C,D>::swap(ConfiguredTransport<C,D>& ctransport)
 {
     stop();
     std::swap(mDevice, ctransport.mDevice);
+    std::swap_ranges(mWriteStorage, mWriteStorage + C::WriteBufferSize, 
+                     ctransport.mWriteStorage);
+    std::swap_ranges(mReadStorage, mReadStorage + C::ReadBufferSize, 
+                     ctransport.mReadStorage);
+    std::swap_ranges(mCobsStorage, mCobsStorage + sizeof(mCobsStorage), 
+                     ctransport.mCobsStorage);
     Transport::swap(ctransport);
 }
 
+////////////////////////////////////////////////////////
+// Integrity                                          //
+////////////////////////////////////////////////////////
+template <typename C, typename D>
+typename ConfiguredTransport<C,D>::ChecksumType
+ConfiguredTransport<C,D>::initialChecksum()
+{
+    return Integrity<C::Integrity>::initial();
+}
+
+template <typename C, typename D>
+typename ConfiguredTransport<C,D>::ChecksumType
+ConfiguredTransport<C,D>::calculateChecksum(ChecksumType cs, const void* ptr, uint32_t size)
+{
+    return Integrity<C::Integrity>::update(cs, ptr, size);
+}
+
+template <typename C, typename D>
+uint32_t
+ConfiguredTransport<C,D>::checksumSize() const
+{
+    return sizeof(typename Integrity<C::Integrity>::ValueType);
+}
+
+template <typename C, typename D>
+void
+ConfiguredTransport<C,D>::writeChecksum(ChecksumType cs)
+{
+    // fixed size even in varint frames, the reader 
+    // finds it at the end of the frame
+    typename Integrity<C::Integrity>::ValueType value = Integrity<C::Integrity>::value(cs);
+    fixEndianness<C::Endianness,sizeof(value)>(&value);
+    Transport::write(&value, sizeof(value));
+}
+
+template <typename C, typename D>
+bool
+ConfiguredTransport<C,D>::readChecksum(ChecksumType cs)
+{
+    typename Integrity<C::Integrity>::ValueType readValue;
+    Transport::read(&readValue, sizeof(readValue));
+    fixEndianness<C::Endianness,sizeof(readValue)>(&readValue);
+    return readValue == Integrity<C::Integrity>::value(cs);
+}
+
 ////////////////////////////////////////////////////////
 // Low level methods                                  //
 ////////////////////////////////////////////////////////
 template <typename C, typename D>
 void
-ConfiguredTransport<C,D>::write(const void* ptr, uint32_t size)
+ConfiguredTransport<C,D>::deviceWrite(const void* ptr, uint32_t size)
 {
     if(isFunctional() && !mDevice->write((uint8_t*)ptr, size)) {
         setError();
@@ -546,13 +2126,27 @@ ConfiguredTransport<C,D>::write(const void* ptr, uint32_t size)
 
 template <typename C, typename D>
 void
-ConfiguredTransport<C,D>::read(void* ptr, uint32_t size) 
+ConfiguredTransport<C,D>::deviceWrite(const IoChunk* chunks, uint32_t count)
 {
-    if(isFunctional() && !mDevice->read((uint8_t*)ptr, size)) {
+    if(isFunctional() && !mDevice->write(chunks, count)) {
         setError();
     }
 }
 
+template <typename C, typename D>
+uint32_t
+ConfiguredTransport<C,D>::deviceRead(void* ptr, uint32_t size) 
+{
+    uint32_t bytesRead = 0;
+    if(isFunctional()) {
+        bytesRead = mDevice->readSome((uint8_t*)ptr, size);
+        if(bytesRead == 0) {
+            setError();
+        }
+    }
+    return bytesRead;
+}
+
 } // namespace ygg
 
 #endif //YGG_TRANSPORT_IMPL_HPP
@@ -18,7 +18,7 @@ private:
     {
         struct DescriptorRecord 
         {
-            TypeDescriptorBase::UnitType    mId;
+            TypeDescriptorBase::IdType      mId;
             TypeDescriptorBase::VersionType mVersion;
             std::string                     mName;
         };
@@ -27,9 +27,15 @@ private:
         typedef typename DescriptorList::const_iterator DescriptorListConstIt;
         ManifestData();
         void addRecord(TypeDescriptorBase* desc);
+        void addLinkOptions(uint32_t options);
         void write(Transport& transport) const;
         void read(Transport& transport);
         DescriptorList mDescriptorRecords;
+        uint32_t       mLinkOptions;
+    private:
+        static const char* linkOptionName(uint32_t option);
+        static std::string wideRecordName(const DescriptorRecord& drecord);
+        static bool        parseWideRecord(DescriptorRecord& drecord);
     };
     class SystemCmdData: public Serializable<SystemCmdData>
     {
@@ -65,35 +71,47 @@ public:
 
 private:
     typedef TypeDescriptorBase::UnitType        UnitType;
+    typedef TypeDescriptorBase::IdType          IdType;
     typedef TypeDescriptorBase::VersionType     VersionType;
-    typedef std::vector<UnitType>               TypeIdMap;
+    // indexed by the foreign id, flat so the lookup stays a single load
+    typedef std::vector<IdType>                 TypeIdMap;
 
 public:
     // public API
     template<typename Type> static bool addType(const std::string& name, 
-                                                const int version);
+                                                const int version,
+                                                TypeCodec codec = TYPE_CODEC_PLAIN);
     template<typename Type> static bool isType(TypeBase* d);
-    static TypeBase* instantiateForeignType(UnitType fType);
-    static TypeBase* instantiateOwnType(UnitType oType);
-    static bool      isOwnTypeEnabled(UnitType oType);
-    static bool      isForeignTypeEnabled(UnitType oType);
+    template<typename Type> static bool isType(const ObjectView& v);
+    static TypeBase* instantiateForeignType(IdType fType);
+    static TypeBase* instantiateOwnType(IdType oType);
+    static bool      isOwnTypeEnabled(IdType oType);
+    static bool      isForeignTypeEnabled(IdType oType);
     static void      initialize();
-    static TypeBase* extractManifest();
-    static UnitType  findTypeId(const std::string& name, const VersionType version);
+    static TypeBase* extractManifest(uint32_t linkOptions = 0);
+    static IdType    findTypeId(const std::string& name, const VersionType version);
     static void      applyManifest(ManifestData* md);
-    static void      acceptType(UnitType oType, UnitType fType);
+    static void      acceptType(IdType oType, IdType fType);
     static bool      isManifestReceved();
     static void      setManifestReceived(bool flag);
+    static bool      isSystemType(IdType type);
+    static bool      isDeltaType(IdType oType);
+    static IdType    foreignTypeToOwnType(const IdType fType);
+    // gives every registered type a pool of capacity objects, 
+    // types that have one already keep it
+    template<typename Pool> static void createPools(uint32_t capacity);
+    static ObjectPoolBase::Statistics poolStatistics(IdType oType);
 
     static TypeDescriptorConstIt descriptorBegin();
     static TypeDescriptorConstIt descriptorEnd();
 
 private:
-    static UnitType  foreignTypeToOwnType(const UnitType fType);
     static void      setTypeState(uint32_t typeId, bool enable);
     static DescriptorState& descriptorStateAt(uint32_t typeId);
     static bool      isValidType(uint32_t typeId);
     static void      reset();
+    // types coded differently don't match in the manifest
+    static std::string recordName(const TypeDescriptorBase* desc);
 
 private:
     TypeRegistry();
@@ -107,19 +125,20 @@ private:
     TypeIdMap           mTypeMap;
     TypeDescriptorArray mDescriptors;
     bool                mManifestReceived;
-    const UnitType      INVALID_TYPE_ID;
+    const IdType        INVALID_TYPE_ID;
 };
 
 
 inline
 TypeRegistry::TypeRegistry() 
  :  mManifestReceived(false),
-    INVALID_TYPE_ID(std::numeric_limits<UnitType>::max())
+    INVALID_TYPE_ID(std::numeric_limits<IdType>::max())
 {}
 
 
 inline
 TypeRegistry::ManifestData::ManifestData()
+ : mLinkOptions(0)
 {}
 
 inline void 
@@ -130,7 +149,77 @@ TypeRegistry::ManifestData::addRecord(TypeDescriptorBase* desc)
     DescriptorRecord& drecord = mDescriptorRecords.back();
     drecord.mId = desc->typeId();
     drecord.mVersion = desc->typeVersion();
-    drecord.mName = desc->typeName();
+    drecord.mName = recordName(desc);
+}
+
+inline void 
+TypeRegistry::ManifestData::addLinkOptions(uint32_t options)
+{
+    // options go as records no type can match, older
+    // peers just ignore them
+    for(uint32_t option = 1; option; option <<= 1) {
+        const char* name = linkOptionName(option);
+        if((options & option) && name) {
+            mDescriptorRecords.push_back(DescriptorRecord());
+            DescriptorRecord& drecord = mDescriptorRecords.back();
+            drecord.mId = 0;
+            drecord.mVersion = 1;
+            drecord.mName = name;
+        }
+    }
+}
+
+inline const char*
+TypeRegistry::ManifestData::linkOptionName(uint32_t option)
+{
+    switch(option) {
+        case Transport::LINK_VARINT: 
+            return "@varint";
+        case Transport::LINK_LENGTH: 
+            return "@length";
+        case Transport::LINK_WIDE_ID: 
+            return "@wideid";
+        case Transport::LINK_SEQUENCE: 
+            return "@seq";
+        default:
+            return NULL;
+    }
+}
+
+inline std::string
+TypeRegistry::ManifestData::wideRecordName(const DescriptorRecord& drecord)
+{
+    // "@<id>:<name>"
+    char digits[8];
+    uint32_t size = 0;
+    for(uint32_t id = drecord.mId; id || !size; id /= 10) {
+        digits[size++] = '0' + id % 10;
+    }
+    std::string name("@");
+    while(size) {
+        name += digits[--size];
+    }
+    return name + ":" + drecord.mName;
+}
+
+inline bool
+TypeRegistry::ManifestData::parseWideRecord(DescriptorRecord& drecord)
+{
+    const std::string& name = drecord.mName;
+    uint32_t id = 0;
+    uint32_t pos = 1;
+    for(; pos < name.size() && name[pos] >= '0' && name[pos] <= '9'; ++pos) {
+        id = id * 10 + (name[pos] - '0');
+        if(id > std::numeric_limits<IdType>::max()) {
+            return false;
+        }
+    }
+    if(pos == 1 || pos == name.size() || name[pos] != ':') {
+        return false;
+    }
+    drecord.mId = id;
+    drecord.mName = name.substr(pos + 1);
+    return true;
 }
 
 inline void 
@@ -140,9 +229,16 @@ TypeRegistry::ManifestData::write(Transport& transport) const
     DescriptorListConstIt dit = mDescriptorRecords.begin();
     DescriptorListConstIt edit = mDescriptorRecords.end();
     for(; dit != edit; ++dit) {
-        transport.write(dit->mId);
-        transport.write(dit->mVersion);
-        transport.write(dit->mName);
+        if(dit->mId < TypeBase::WIDE_ID_BEGIN) {
+            transport.write((UnitType)dit->mId);
+            transport.write(dit->mVersion);
+            transport.write(dit->mName);
+        } else {
+            // 8-bit peers skip the records starting with '@'
+            transport.write((UnitType)0);
+            transport.write(dit->mVersion);
+            transport.write(wideRecordName(*dit));
+        }
     }
 }
 
@@ -151,13 +247,28 @@ TypeRegistry::ManifestData::read(Transport& transport)
 {
     uint32_t dSize;
     transport.readChecksumed(dSize);
-    if(transport.isFunctional()) {
-        for(uint32_t i = 0; i < dSize; ++i) {
+    // a broken value or record leaves the transport waiting for 
+    // the next sync, the count can't be trusted any more then
+    if(transport.isFunctional() && !transport.isWaitSync()) {
+        for(uint32_t i = 0; i < dSize && transport.isFunctional() && 
+                            !transport.isWaitSync(); ++i) {
             mDescriptorRecords.push_back(DescriptorRecord());
             DescriptorRecord& drecord = mDescriptorRecords.back();
-            transport.read(drecord.mId);
+            UnitType id;
+            transport.read(id);
+            drecord.mId = id;
             transport.read(drecord.mVersion);
             transport.read(drecord.mName);
+            if(!drecord.mName.empty() && drecord.mName[0] == '@' && 
+               !parseWideRecord(drecord)) {
+                for(uint32_t option = 1; option; option <<= 1) {
+                    const char* name = linkOptionName(option);
+                    if(name && drecord.mName == name) {
+                        mLinkOptions |= option;
+                    }
+                }
+                mDescriptorRecords.pop_back();
+            }
         }
     }
 }
@@ -207,7 +318,7 @@ TypeRegistry::DescriptorState::DescriptorState(TypeDescriptorBase* desc, bool en
 
 template<class Type>
 bool 
-TypeRegistry::addType(const std::string& name, const int version)
+TypeRegistry::addType(const std::string& name, const int version, TypeCodec codec)
 {
     if(self().mDescriptors.size() == self().INVALID_TYPE_ID) {
         return false;
@@ -218,7 +329,7 @@ TypeRegistry::addType(const std::string& name, const int version)
         self().mDescriptors.resize(2);
     }
     TypeDescriptorBase* tDesc = 
-        new TypeDescriptor<Type>(self().mDescriptors.size(), version, name);
+        new TypeDescriptor<Type>(self().mDescriptors.size(), version, name, codec);
     self().mDescriptors.push_back(DescriptorState(tDesc, false));
     return true;
 }
@@ -230,10 +341,17 @@ TypeRegistry::isType(TypeBase* d)
     return d->id() == TypeDescriptor<Type>::id();
 }
 
+template<typename Type>
+inline bool 
+TypeRegistry::isType(const ObjectView& v)
+{
+    return v.id() == TypeDescriptor<Type>::id();
+}
+
 inline TypeBase*  
-TypeRegistry::instantiateForeignType(UnitType fType)
+TypeRegistry::instantiateForeignType(IdType fType)
 {
-    UnitType oType = foreignTypeToOwnType(fType);
+    IdType oType = foreignTypeToOwnType(fType);
     if(oType != self().INVALID_TYPE_ID) {
         return instantiateOwnType(oType);
     }
@@ -241,7 +359,7 @@ TypeRegistry::instantiateForeignType(UnitType fType)
 }
 
 inline TypeBase* 
-TypeRegistry::instantiateOwnType(UnitType oType) 
+TypeRegistry::instantiateOwnType(IdType oType) 
 {
     if(isValidType(oType) && isOwnTypeEnabled(oType)) {
         const DescriptorState& state = descriptorStateAt(oType);
@@ -251,14 +369,14 @@ TypeRegistry::instantiateOwnType(UnitType oType)
 }
 
 inline bool  
-TypeRegistry::isForeignTypeEnabled(UnitType fType) 
+TypeRegistry::isForeignTypeEnabled(IdType fType) 
 {
-    UnitType oType = foreignTypeToOwnType(fType);
+    IdType oType = foreignTypeToOwnType(fType);
     return isOwnTypeEnabled(oType);
 }
 
 inline bool 
-TypeRegistry::isOwnTypeEnabled(UnitType oType) 
+TypeRegistry::isOwnTypeEnabled(IdType oType) 
 {
     if(isValidType(oType)) {
         return descriptorStateAt(oType).enabled;
@@ -282,7 +400,7 @@ TypeRegistry::initialize()
 }
 
 inline TypeBase* 
-TypeRegistry::extractManifest()
+TypeRegistry::extractManifest(uint32_t linkOptions)
 {
     ManifestData* d = new ManifestData();
     TypeDescriptorConstIt dit = self().mDescriptors.begin();
@@ -290,16 +408,17 @@ TypeRegistry::extractManifest()
     for(;  dit != edit; ++dit) {
         d->addRecord(dit->descriptor);
     }
+    d->addLinkOptions(linkOptions);
     return d;
 }
 
-inline typename TypeRegistry::UnitType 
+inline typename TypeRegistry::IdType 
 TypeRegistry::findTypeId(const std::string& name, const VersionType version)
 {
     TypeDescriptorConstIt dit = self().mDescriptors.begin();
     TypeDescriptorConstIt edit = self().mDescriptors.end();
     for(;  dit != edit; ++dit) {
-        if(dit->descriptor->typeName() == name &&
+        if(recordName(dit->descriptor) == name &&
            dit->descriptor->typeVersion() == version) {
             return dit->descriptor->typeId();
         }
@@ -316,7 +435,7 @@ TypeRegistry::applyManifest(ManifestData* md)
     typename ManifestData::DescriptorListConstIt edit = md->mDescriptorRecords.end();
     for(; dit != edit; ++dit) {
         // type is accepted if it has the same id AND version AND name!
-        UnitType oType = findTypeId(dit->mName, dit->mVersion);
+        IdType oType = findTypeId(dit->mName, dit->mVersion);
         if(oType != self().INVALID_TYPE_ID)  { 
             acceptType(oType, dit->mId);
         }
@@ -327,7 +446,7 @@ TypeRegistry::applyManifest(ManifestData* md)
 }
 
 inline void 
-TypeRegistry::acceptType(UnitType oType, UnitType fType) 
+TypeRegistry::acceptType(IdType oType, IdType fType) 
 {
     if(fType >= self().mTypeMap.size()) {
         self().mTypeMap.resize(fType+1, self().INVALID_TYPE_ID);
@@ -348,6 +467,53 @@ TypeRegistry::setManifestReceived(bool flag)
     self().mManifestReceived = flag;
 }
 
+inline bool 
+TypeRegistry::isSystemType(IdType type)
+{
+    // manifest and system commands
+    return type < 2;
+}
+
+inline bool 
+TypeRegistry::isDeltaType(IdType oType)
+{
+    return isValidType(oType) && descriptorStateAt(oType).descriptor &&
+           descriptorStateAt(oType).descriptor->typeCodec() == TYPE_CODEC_DELTA;
+}
+
+inline std::string
+TypeRegistry::recordName(const TypeDescriptorBase* desc)
+{
+    if(desc->typeCodec() == TYPE_CODEC_DELTA) {
+        return desc->typeName() + "/delta";
+    }
+    return desc->typeName();
+}
+
+template<typename Pool>
+inline void 
+TypeRegistry::createPools(uint32_t capacity)
+{
+    TypeDescriptorConstIt dit = self().mDescriptors.begin();
+    TypeDescriptorConstIt edit = self().mDescriptors.end();
+    for(;  dit != edit; ++dit) {
+        TypeDescriptorBase* desc = dit->descriptor;
+        if(desc && desc->pool() == NULL) {
+            desc->setPool(new Pool(desc->objectSize(), capacity));
+        }
+    }
+}
+
+inline ObjectPoolBase::Statistics
+TypeRegistry::poolStatistics(IdType oType)
+{
+    if(isValidType(oType) && descriptorStateAt(oType).descriptor &&
+       descriptorStateAt(oType).descriptor->pool()) {
+        return descriptorStateAt(oType).descriptor->pool()->statistics();
+    }
+    return ObjectPoolBase::Statistics();
+}
+
 inline TypeRegistry::TypeDescriptorConstIt
 TypeRegistry::descriptorBegin() 
 {
@@ -360,8 +526,8 @@ TypeRegistry::descriptorEnd()
     return self().mDescriptors.end();
 }
 
-inline typename TypeRegistry::UnitType 
-TypeRegistry::foreignTypeToOwnType(const UnitType fType) 
+inline typename TypeRegistry::IdType 
+TypeRegistry::foreignTypeToOwnType(const IdType fType) 
 {
     return (fType < self().mTypeMap.size()) ? self().mTypeMap[fType]
                                             : self().INVALID_TYPE_ID;
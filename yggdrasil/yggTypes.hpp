@@ -2,6 +2,7 @@
 #define YGG_DATA_TYPES_HPP
 
 #include "yggBaseTypes.hpp"
+#include "yggPool.hpp"
 #include <string>
 #include <limits>
 
@@ -11,33 +12,77 @@ namespace ygg
 class TypeRegistry;
 class TypeBase;
 class Transport;
+class ObjectView;
 class DummyType {};
 
+// how the objects of a type are coded, chosen at the registration
+// and the same on both ends
+enum TypeCodec
+{
+    // every object is written on its own
+    TYPE_CODEC_PLAIN,
+    // the integer fields are sent as differences to the previous
+    // object of the type, applies to Encodable types only
+    TYPE_CODEC_DELTA
+};
+
 
-class TypeBase
+class TypeBase : public QueueLink
 {
 public:
     typedef uint8_t UnitType;
+    // type identifiers, the ones that don't fit a byte go 
+    // only to peers announcing wide ids
+    typedef uint16_t IdType;
+    enum
+    {
+        // ids from here on need wide frames and manifest records,
+        // 0xFF itself was the invalid id of the 8-bit peers
+        WIDE_ID_BEGIN = 0xFF
+    };
 public:
+    TypeBase()
+     : mArrivalTime(0)
+    {}
     virtual ~TypeBase()
     {}
     virtual void write(Transport& out) const = 0;
     virtual void read(Transport& in)   = 0;
-    virtual UnitType id() const = 0;
+    virtual IdType id() const = 0;
+    // when the sync of the frame carrying the object was read, in 
+    // microseconds of the receiver's Utils::getMicroseconds, 
+    // 0 for objects created locally
+    uint64_t arrivalTime() const
+    {
+        return mArrivalTime;
+    }
+    void setArrivalTime(uint64_t time)
+    {
+        mArrivalTime = time;
+    }
+private:
+    uint64_t mArrivalTime;
 };
 
 class TypeDescriptorBase
 {
 public:
     typedef TypeBase::UnitType UnitType;
+    typedef TypeBase::IdType   IdType;
     typedef uint8_t            VersionType;
 public:
     virtual ~TypeDescriptorBase() 
     {}
-    virtual UnitType           typeId() const = 0;
+    virtual IdType             typeId() const = 0;
     virtual VersionType        typeVersion() const = 0;
     virtual const std::string& typeName() const = 0;
+    virtual TypeCodec          typeCodec() const = 0;
     virtual TypeBase* create() const = 0;
+    // the pool the objects of the type are allocated from, 
+    // NULL while they come from the heap
+    virtual uint32_t        objectSize() const = 0;
+    virtual ObjectPoolBase* pool() const = 0;
+    virtual void            setPool(ObjectPoolBase* pool) = 0;
 };
 
 template <class Type>
@@ -45,14 +90,16 @@ class TypeDescriptor : public TypeDescriptorBase
 {
 private:
     friend class TypeRegistry;
-    TypeDescriptor(UnitType id, VersionType version, const std::string& name) 
+    TypeDescriptor(IdType id, VersionType version, const std::string& name,
+                   TypeCodec codec = TYPE_CODEC_PLAIN) 
       : mVersion(version),
-        mName(name)
+        mName(name),
+        mCodec(codec)
     {
         sId = id;
     }
 public:
-    UnitType typeId() const
+    IdType typeId() const
     {
         return sId;
     }
@@ -64,32 +111,71 @@ public:
     {
         return mName;
     }
+    TypeCodec typeCodec() const
+    {
+        return mCodec;
+    }
     virtual TypeBase* create() const
     { 
         return new Type(); 
     }
+    uint32_t objectSize() const
+    {
+        return sizeof(Type);
+    }
+    ObjectPoolBase* pool() const
+    {
+        return sPool;
+    }
+    void setPool(ObjectPoolBase* pool)
+    {
+        sPool = pool;
+    }
 public:
-    static UnitType id()
+    static IdType id()
     {
         return sId;
     }
+    static ObjectPoolBase* objectPool()
+    {
+        return sPool;
+    }
 private:
     VersionType mVersion;
     std::string mName;
-    static UnitType sId;
+    TypeCodec   mCodec;
+    static IdType sId;
+    // outlives the descriptor, the objects may still be around
+    static ObjectPoolBase* sPool;
 };
 
-template <class Type> TypeDescriptorBase::UnitType TypeDescriptor<Type>::sId;
+template <class Type> TypeDescriptorBase::IdType TypeDescriptor<Type>::sId;
+template <class Type> ObjectPoolBase* TypeDescriptor<Type>::sPool = NULL;
 
 template<typename Type>
 class Serializable: public TypeBase
 {
     friend class TypeRegistry;
 public:
-    virtual UnitType id()  const
+    virtual IdType id()  const
     {
         return TypeDescriptor<Type>::id();
     }
+    // objects of the types with a pool are taken from it and 
+    // given back on delete, the rest go to the heap
+    static void* operator new(size_t size)
+    {
+        ObjectPoolBase* pool = TypeDescriptor<Type>::objectPool();
+        void* ptr = pool ? pool->allocate(size) : NULL;
+        return ptr ? ptr : ::operator new(size);
+    }
+    static void operator delete(void* ptr)
+    {
+        ObjectPoolBase* pool = TypeDescriptor<Type>::objectPool();
+        if(!pool || !pool->release(ptr)) {
+            ::operator delete(ptr);
+        }
+    }
 };
 
 } // namespace ygg
@@ -0,0 +1,121 @@
+#ifndef YGG_VIEW_HPP
+#define YGG_VIEW_HPP
+
+#include "yggFields.hpp"
+#include "yggTransport.hpp"
+#include "yggTransportImpl.hpp"
+#include <string>
+
+namespace ygg
+{
+
+// Read access to a received object without instantiating it, for the
+// types with a field list. Fields are decoded where they lie in the
+// read buffer when asked for, by their index in the list:
+//
+//     if(registry::isType<rat::PingData>(v)) {
+//         ygg::View<rat::PingData> ping(v);
+//         uint32_t stamp = ping.get<0>();
+//     }
+//
+// The view is valid as long as the ObjectView it was made from.
+
+// moves the reads past a field without keeping it
+template <class T>
+struct FieldSkip
+{
+    static void skip(Transport& in)
+    {
+        T v;
+        FieldType<T>::decode(in, v);
+    }
+};
+
+template <>
+struct FieldSkip<std::string>
+{
+    static void skip(Transport& in)
+    {
+        const char* str;
+        uint32_t len;
+        in.readView(str, len);
+    }
+};
+
+// the field I of the list L and what comes before it:
+//     OFFSET - where it starts, if all the fields before are FIXED
+template <class L, int I>
+struct FieldAt
+{
+    typedef FieldAt<typename L::Rest, I - 1> Next;
+    typedef typename Next::Type Type;
+    enum
+    {
+        OFFSET = L::First::SIZE + Next::OFFSET,
+        FIXED  = L::First::FIXED && Next::FIXED
+    };
+    static void skip(Transport& in)
+    {
+        FieldSkip<typename L::First::Value>::skip(in);
+        Next::skip(in);
+    }
+};
+
+template <class L>
+struct FieldAt<L, 0>
+{
+    typedef typename L::First Type;
+    enum
+    {
+        OFFSET = 0,
+        FIXED  = true
+    };
+    static void skip(Transport&)
+    {}
+};
+
+template <class Type>
+class View
+{
+    typedef typename FieldsOf<Type>::Type Fields;
+public:
+    View(const ObjectView& view)
+     : mView(view)
+    {}
+    // decodes the field I, false if the object is too short for it
+    template <int I> bool get(typename FieldAt<Fields,I>::Type::Value& v) const
+    {
+        typedef FieldAt<Fields,I> At;
+        // with fixed size integers the offset is known, no need to skip
+        bool direct = At::FIXED && !mView.isVarint();
+        Transport& in = mView.reader(direct ? At::OFFSET : 0);
+        if(!direct) {
+            At::skip(in);
+        }
+        FieldType<typename At::Type::Value>::decode(in, v);
+        return in.isFunctional();
+    }
+    template <int I> typename FieldAt<Fields,I>::Type::Value get() const
+    {
+        typename FieldAt<Fields,I>::Type::Value v = typename FieldAt<Fields,I>::Type::Value();
+        get<I>(v);
+        return v;
+    }
+    // decodes all the fields into v
+    bool load(Type& v) const
+    {
+        Transport& in = mView.reader();
+        Fields::decode(in, v);
+        return in.isFunctional();
+    }
+    const ObjectView& object() const
+    {
+        return mView;
+    }
+private:
+    const ObjectView& mView;
+};
+
+} // namespace ygg
+
+#endif //YGG_VIEW_HPP